@@ -0,0 +1,158 @@
+#pragma once
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include "traits.hpp"
+
+namespace ft
+{
+	class arena;
+	template <class T>
+	class arena_allocator;
+}
+
+/*
+** Monotonic memory: allocations bump a pointer through big chunks and are
+** never freed one by one. reset() gives everything back at once (keeping
+** the newest chunk for reuse), so containers allocated from the arena must
+** be gone or abandoned by then.
+*/
+class ft::arena
+{
+public:
+	explicit arena(std::size_t chunk_size = 1 << 20) : _chunks(NULL),
+													   _cur(NULL),
+													   _end(NULL),
+													   _chunk_size(chunk_size) {}
+	~arena()
+	{
+		reset();
+		if (_chunks)
+			::operator delete(_chunks);
+	}
+
+	void *allocate(std::size_t bytes, std::size_t align)
+	{
+		if (!_cur || padding(align) + bytes > std::size_t(_end - _cur))
+			grow(bytes + align);
+		char *p = _cur + padding(align);
+		_cur = p + bytes;
+		return p;
+	}
+	void reset()
+	{
+		if (!_chunks)
+			return;
+		while (_chunks->next)
+		{
+			chunk *c = _chunks->next;
+			_chunks->next = c->next;
+			::operator delete(c);
+		}
+		_cur = reinterpret_cast<char *>(_chunks + 1);
+	}
+	std::size_t capacity() const
+	{
+		std::size_t n = 0;
+		for (chunk *c = _chunks; c; c = c->next)
+			n += c->size;
+		return n;
+	}
+
+private:
+	enum { MAX_CHUNK = 64 << 20 };
+	struct chunk
+	{
+		chunk *next;
+		std::size_t size;
+	};
+	chunk *_chunks;
+	char *_cur;
+	char *_end;
+	std::size_t _chunk_size;
+
+	arena(const arena &);
+	arena &operator=(const arena &);
+
+	std::size_t padding(std::size_t align) const
+	{
+		return (align - reinterpret_cast<std::size_t>(_cur) % align) % align;
+	}
+
+	void grow(std::size_t need)
+	{
+		std::size_t size = _chunk_size;
+		if (size < need + sizeof(chunk))
+			size = need + sizeof(chunk);
+		chunk *c = static_cast<chunk *>(::operator new(size));
+		c->size = size;
+		c->next = _chunks;
+		_chunks = c;
+		_cur = reinterpret_cast<char *>(c + 1);
+		_end = reinterpret_cast<char *>(c) + size;
+		if (_chunk_size < MAX_CHUNK)
+			_chunk_size *= 2;
+	}
+};
+
+/*
+** Standard allocator interface over an ft::arena. deallocate() does
+** nothing; rebound copies (e.g. rbtree nodes) draw from the same arena.
+*/
+template <class T>
+class ft::arena_allocator
+{
+public:
+	typedef T value_type;
+	typedef T *pointer;
+	typedef const T *const_pointer;
+	typedef T &reference;
+	typedef const T &const_reference;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	template <class U>
+	struct rebind { typedef arena_allocator<U> other; };
+
+	arena_allocator(arena &a) : _arena(&a) {}
+	arena_allocator(const arena_allocator &other) : _arena(other._arena) {}
+	template <class U>
+	arena_allocator(const arena_allocator<U> &other) : _arena(other.get_arena()) {}
+	~arena_allocator() {}
+	arena_allocator &operator=(const arena_allocator &other)
+	{
+		_arena = other._arena;
+		return (*this);
+	}
+
+	pointer address(reference x) const { return &x; }
+	const_pointer address(const_reference x) const { return &x; }
+	pointer allocate(size_type n, const void * = 0)
+	{
+		return static_cast<pointer>(_arena->allocate(n * sizeof(T), __alignof__(T)));
+	}
+	void deallocate(pointer, size_type) {}
+	size_type max_size() const { return std::allocator<T>().max_size(); }
+#if __cplusplus >= 201103L
+	template <class U, class... Args>
+	void construct(U *p, Args &&...args) { ::new ((void *)p) U(std::forward<Args>(args)...); }
+	template <class U>
+	void destroy(U *p) { p->~U(); }
+#else
+	void construct(pointer p, const T &val) { new (p) T(val); }
+	void destroy(pointer p) { p->~T(); }
+#endif
+	arena *get_arena() const { return _arena; }
+
+	bool operator==(const arena_allocator &other) const { return _arena == other._arena; }
+	bool operator!=(const arena_allocator &other) const { return _arena != other._arena; }
+
+private:
+	arena *_arena;
+};
+
+namespace ft
+{
+	template <class T>
+	struct is_monotonic_allocator<arena_allocator<T> > : true_type {};
+}
@@ -0,0 +1,975 @@
+/* **************************************************************************
+
+Compile && run:
+
+clang++ -Wall -Wextra -Werror -std=c++98 -pedantic -O2 -pthread bench.cpp && ./a.out [name]
+
+Without a name every benchmark runs. Times are CPU seconds from clock(),
+except for the multi-threaded ones, which are wall-clock seconds.
+
+************************************************************************** */
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <stack>
+#include <deque>
+#include <algorithm>
+#include <vector>
+#include <sstream>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sched.h>
+#include "map.hpp"
+#include "rbtree_parallel.hpp"
+#include "set.hpp"
+#include "flat_map.hpp"
+#include "btree_map.hpp"
+#include "unordered_map.hpp"
+#include "concurrent_map.hpp"
+#include "sharded_map.hpp"
+#include "persistent_map.hpp"
+#include "concurrent_stack.hpp"
+#include "mpmc_queue.hpp"
+#include "stack.hpp"
+#include "deque.hpp"
+#include "vector.hpp"
+
+// results are stored here so the optimizer keeps the measured loops
+static volatile int g_sink;
+
+static double seconds(clock_t since)
+{
+	return double(clock() - since) / CLOCKS_PER_SEC;
+}
+
+static void report(const char *what, double s)
+{
+	std::cout << "  " << std::left << std::setw(40) << what
+			  << std::right << std::fixed << std::setprecision(3) << s << " s" << std::endl;
+}
+
+/*
+** pool: insert/erase churn on a map, pooled nodes vs one malloc per node
+*/
+
+template <class Map>
+double map_churn(int count, int rounds)
+{
+	clock_t start = clock();
+	{
+		Map m;
+		srand(42);
+		for (int i = 0; i < count; i++)
+			m.insert(ft::make_pair(rand() % (count * 2), i));
+		for (int r = 0; r < rounds; r++)
+			for (int i = 0; i < count; i++)
+			{
+				m.erase(rand() % (count * 2));
+				m.insert(ft::make_pair(rand() % (count * 2), i));
+			}
+		int sum = 0;
+		for (typename Map::const_iterator it = m.begin(); it != m.end(); ++it)
+			sum += it->second;
+		g_sink = sum;
+	}
+	return seconds(start);
+}
+
+static void bench_pool()
+{
+	const int count = 200000;
+	std::cout << "pool: " << count << " keys, insert + 4 rounds of erase/insert + destroy" << std::endl;
+	report("ft::map, pool_allocator (default)", map_churn<ft::map<int, int> >(count, 4));
+	report("ft::map, std::allocator",
+		   map_churn<ft::map<int, int, std::less<int>, std::allocator<ft::pair<const int, int> > > >(count, 4));
+}
+
+/*
+** vector: mid-vector insert/erase on a large vector of PODs, and growing a
+** vector of 4 KB structs like main.cpp's Buffer
+*/
+
+struct Buffer
+{
+	int idx;
+	char buff[4096];
+};
+
+template <class Vector>
+double vector_shift(int count, int ops)
+{
+	clock_t start = clock();
+	Vector v(count, 1);
+	for (int i = 0; i < ops; i++)
+	{
+		v.insert(v.begin() + v.size() / 2, i);
+		v.erase(v.begin() + v.size() / 3);
+	}
+	g_sink = v[v.size() / 2];
+	return seconds(start);
+}
+
+template <class Vector>
+double vector_grow(int count)
+{
+	clock_t start = clock();
+	{
+		Vector v;
+		for (int i = 0; i < count; i++)
+			v.push_back(Buffer());
+		g_sink = v[count / 2].idx;
+	}
+	return seconds(start);
+}
+
+static void bench_vector()
+{
+	std::cout << "vector: 4M ints, 2000 mid inserts + erases" << std::endl;
+	report("ft::vector<int>", vector_shift<ft::vector<int> >(4000000, 2000));
+	report("std::vector<int>", vector_shift<std::vector<int> >(4000000, 2000));
+	std::cout << "vector: push_back 100k Buffers (4 KB)" << std::endl;
+	vector_grow<std::vector<Buffer> >(100000); // warm up the heap
+	report("ft::vector<Buffer>", vector_grow<ft::vector<Buffer> >(100000));
+	report("std::vector<Buffer>", vector_grow<std::vector<Buffer> >(100000));
+}
+
+/*
+** growth: memory held while push_back builds a large vector, doubling vs
+** 3/2 growth. A counting allocator tracks the bytes live at once.
+*/
+
+static std::size_t g_live, g_peak;
+
+template <class T>
+struct counting_allocator : std::allocator<T>
+{
+	template <class U>
+	struct rebind { typedef counting_allocator<U> other; };
+
+	counting_allocator() {}
+	template <class U>
+	counting_allocator(const counting_allocator<U> &) {}
+
+	T *allocate(std::size_t n, const void * = 0)
+	{
+		g_live += n * sizeof(T);
+		if (g_live > g_peak)
+			g_peak = g_live;
+		return std::allocator<T>::allocate(n);
+	}
+	void deallocate(T *p, std::size_t n)
+	{
+		g_live -= n * sizeof(T);
+		std::allocator<T>::deallocate(p, n);
+	}
+};
+
+template <class Vector>
+void vector_footprint(const char *what, int count)
+{
+	g_live = 0;
+	g_peak = 0;
+	clock_t start = clock();
+	Vector v;
+	for (int i = 0; i < count; i++)
+		v.push_back(i);
+	double s = seconds(start);
+	double data = double(count) * sizeof(int);
+	std::cout << "  " << std::left << std::setw(40) << what << std::right << std::fixed << std::setprecision(3)
+			  << s << " s  slack " << std::setw(5) << std::setprecision(2) << (g_live - data) / data
+			  << "  peak " << double(g_peak) / data << "x" << std::endl;
+	v.shrink_to_fit();
+	std::cout << "  " << std::left << std::setw(40) << "  after shrink_to_fit" << std::right
+			  << "slack " << (g_live - data) / data << std::endl;
+	g_sink = v[count / 2];
+}
+
+static void bench_growth()
+{
+	const int count = 5000000;
+	std::cout << "growth: push_back " << count << " ints; slack = unused / used, peak = max live / used" << std::endl;
+	vector_footprint<ft::vector<int, counting_allocator<int> > >("ft::vector, x2 (default)", count);
+	vector_footprint<ft::vector<int, counting_allocator<int>, ft::geometric_growth<3, 2> > >("ft::vector, x1.5", count);
+}
+
+/*
+** bulk: building a map from sorted pairs, range constructor (linear build)
+** vs one insert per element
+*/
+
+template <class Map, class Pairs>
+double map_from_range(const Pairs &pairs)
+{
+	clock_t start = clock();
+	Map m(pairs.begin(), pairs.end());
+	g_sink = m.size();
+	return seconds(start);
+}
+
+template <class Map, class Pairs>
+double map_by_insert(const Pairs &pairs)
+{
+	clock_t start = clock();
+	Map m;
+	for (typename Pairs::const_iterator it = pairs.begin(); it != pairs.end(); ++it)
+		m.insert(*it);
+	g_sink = m.size();
+	return seconds(start);
+}
+
+static void bench_bulk()
+{
+	const int count = 10000000;
+	std::vector<ft::pair<int, int> > ft_pairs;
+	std::vector<std::pair<int, int> > std_pairs;
+	for (int i = 0; i < count; i++)
+	{
+		ft_pairs.push_back(ft::make_pair(i, i));
+		std_pairs.push_back(std::make_pair(i, i));
+	}
+	std::cout << "bulk: map from " << count << " sorted pairs (build + destroy)" << std::endl;
+	report("ft::map range constructor", map_from_range<ft::map<int, int> >(ft_pairs));
+	report("ft::map insert loop", map_by_insert<ft::map<int, int> >(ft_pairs));
+	report("std::map range constructor", map_from_range<std::map<int, int> >(std_pairs));
+}
+
+/*
+** append: 10M increasing keys one insert at a time, as a time series
+** fills, plus the same keys in decreasing order
+*/
+
+template <class Map>
+double appends(int count, bool hinted)
+{
+	clock_t start = clock();
+	Map m;
+	for (int i = 0; i < count; i++)
+		if (hinted)
+			m.insert(m.end(), typename Map::value_type(i, i));
+		else
+			m.insert(typename Map::value_type(i, i));
+	g_sink = m.size();
+	return seconds(start);
+}
+
+template <class Map>
+double prepends(int count)
+{
+	clock_t start = clock();
+	Map m;
+	for (int i = count; i > 0; i--)
+		m.insert(typename Map::value_type(i, i));
+	g_sink = m.size();
+	return seconds(start);
+}
+
+static void bench_append()
+{
+	const int count = 10000000;
+	std::cout << "append: " << count << " sorted keys one by one (build + destroy)" << std::endl;
+	report("ft::map insert(v)", appends<ft::map<int, int> >(count, false));
+	report("ft::map insert(end(), v)", appends<ft::map<int, int> >(count, true));
+	report("ft::map insert(v), decreasing", prepends<ft::map<int, int> >(count));
+	report("std::map insert(v)", appends<std::map<int, int> >(count, false));
+	report("std::map insert(end(), v)", appends<std::map<int, int> >(count, true));
+}
+
+/*
+** range: dropping the middle 1M keys of a 2M-key map, range erase (split +
+** join, then freeing) vs erasing node by node
+*/
+
+template <class Map>
+void fill_sorted(Map &m, int count)
+{
+	for (int i = 0; i < count; i++)
+		m.insert(m.end(), typename Map::value_type(i, i));
+}
+
+template <class Map>
+double range_erase(int count)
+{
+	Map m;
+	fill_sorted(m, count);
+	clock_t start = clock();
+	m.erase(m.lower_bound(count / 4), m.lower_bound(count / 4 * 3));
+	g_sink = m.size();
+	return seconds(start);
+}
+
+template <class Map>
+double node_erase(int count)
+{
+	Map m;
+	fill_sorted(m, count);
+	clock_t start = clock();
+	typename Map::iterator it = m.lower_bound(count / 4), last = m.lower_bound(count / 4 * 3);
+	while (it != last)
+		m.erase(it++);
+	g_sink = m.size();
+	return seconds(start);
+}
+
+static void bench_range()
+{
+	const int count = 2000000;
+	std::cout << "range: erase the middle " << count / 2 << " keys of " << count << std::endl;
+	report("ft::map erase(first, last)", range_erase<ft::map<int, int> >(count));
+	report("ft::map erase one by one", node_erase<ft::map<int, int> >(count));
+	report("std::map erase(first, last)", range_erase<std::map<int, int> >(count));
+}
+
+/*
+** algebra: set union/intersection built by merge, vs a find or insert per
+** element of one set into (a copy of) the other
+*/
+
+static void random_set(ft::set<int> &s, int count, int range)
+{
+	while ((int)s.size() < count)
+		s.insert(rand() % range);
+}
+
+static double intersect_by_find(const ft::set<int> &a, const ft::set<int> &b)
+{
+	clock_t start = clock();
+	ft::set<int> r;
+	for (ft::set<int>::const_iterator it = a.begin(); it != a.end(); ++it)
+		if (b.find(*it) != b.end())
+			r.insert(r.end(), *it);
+	g_sink = r.size();
+	return seconds(start);
+}
+
+static double union_by_insert(const ft::set<int> &a, const ft::set<int> &b)
+{
+	clock_t start = clock();
+	ft::set<int> r(a);
+	for (ft::set<int>::const_iterator it = b.begin(); it != b.end(); ++it)
+		r.insert(*it);
+	g_sink = r.size();
+	return seconds(start);
+}
+
+static void bench_algebra()
+{
+	const int count = 1000000;
+	ft::set<int> a, b, small;
+	srand(42);
+	random_set(a, count, count * 4);
+	random_set(b, count, count * 4);
+	random_set(small, 1000, count * 4);
+	clock_t start;
+	std::cout << "algebra: two random sets of " << count << " ints" << std::endl;
+	start = clock();
+	g_sink = a.set_intersection(b).size();
+	report("set_intersection", seconds(start));
+	report("find loop", intersect_by_find(a, b));
+	start = clock();
+	g_sink = a.set_union(b).size();
+	report("set_union", seconds(start));
+	report("copy + insert loop", union_by_insert(a, b));
+	std::cout << "algebra: 1000 ints against " << count << std::endl;
+	start = clock();
+	for (int i = 0; i < 100; i++)
+		g_sink = small.set_intersection(a).size();
+	report("set_intersection x100", seconds(start));
+}
+
+/*
+** flat: random finds in a read-only table of 1M int keys, sorted arrays
+** vs rbtree nodes, and the bytes each layout allocates per entry
+*/
+
+template <class Map>
+double lookups(const Map &m, const std::vector<int> &keys)
+{
+	clock_t start = clock();
+	int sum = 0;
+	for (int r = 0; r < 5; r++)
+		for (std::size_t i = 0; i < keys.size(); i++)
+		{
+			typename Map::const_iterator it = m.find(keys[i]);
+			if (it != m.end())
+				sum += it->second;
+		}
+	g_sink = sum;
+	return seconds(start);
+}
+
+template <class Map>
+double footprint(const std::vector<ft::pair<int, int> > &pairs)
+{
+	g_live = 0;
+	Map m(pairs.begin(), pairs.end());
+	return double(g_live) / m.size();
+}
+
+static void bench_flat()
+{
+	const int count = 1000000;
+	std::vector<ft::pair<int, int> > pairs;
+	std::vector<int> keys;
+	srand(42);
+	for (int i = 0; i < count; i++)
+	{
+		pairs.push_back(ft::make_pair(rand(), i));
+		keys.push_back(rand() % 2 ? pairs.back().first : rand());
+	}
+	{
+		ft::flat_map<int, int> flat(pairs.begin(), pairs.end());
+		ft::map<int, int> tree(pairs.begin(), pairs.end());
+		std::map<int, int> stl;
+		for (int i = 0; i < count; i++)
+			stl.insert(std::make_pair(pairs[i].first, pairs[i].second));
+		std::cout << "flat: " << 5 * count << " random finds in " << flat.size() << " entries" << std::endl;
+		report("ft::flat_map", lookups(flat, keys));
+		report("ft::map", lookups(tree, keys));
+		report("std::map", lookups(stl, keys));
+	}
+	typedef counting_allocator<int> ints;
+	typedef counting_allocator<ft::pair<const int, int> > pairs_alloc;
+	std::cout << "flat: bytes allocated per <int, int> entry" << std::endl;
+	std::cout << "  ft::flat_map                        "
+			  << footprint<ft::flat_map<int, int, std::less<int>, ft::vector<int, ints>, ft::vector<int, ints> > >(pairs) << std::endl;
+	std::cout << "  ft::map                             "
+			  << footprint<ft::map<int, int, std::less<int>, pairs_alloc> >(pairs) << std::endl;
+}
+
+/*
+** btree: 10M random int keys in a B+-tree vs the rbtree map: building by
+** insertion, random finds, and scans of 100 keys from random lower_bounds
+*/
+
+template <class Map>
+double build(Map &m, const std::vector<int> &keys)
+{
+	clock_t start = clock();
+	for (std::size_t i = 0; i < keys.size(); i++)
+		m.insert(ft::make_pair(keys[i], (int)i));
+	return seconds(start);
+}
+
+template <class Map>
+double scans(const Map &m, const std::vector<int> &keys, int count)
+{
+	clock_t start = clock();
+	int sum = 0;
+	for (int i = 0; i < count; i++)
+	{
+		typename Map::const_iterator it = m.lower_bound(keys[i]);
+		for (int n = 0; n < 100 && it != m.end(); n++, ++it)
+			sum += it->second;
+	}
+	g_sink = sum;
+	return seconds(start);
+}
+
+static void bench_btree()
+{
+	const int count = 10000000;
+	std::vector<int> keys;
+	srand(42);
+	for (int i = 0; i < count; i++)
+		keys.push_back(rand());
+	ft::btree_map<int, int> bt;
+	ft::map<int, int> rb;
+	std::cout << "btree: " << count << " random int keys" << std::endl;
+	report("ft::btree_map insert", build(bt, keys));
+	report("ft::map insert", build(rb, keys));
+	std::vector<int> probes(keys.begin(), keys.begin() + count / 10);
+	report("ft::btree_map 5M finds", lookups(bt, probes));
+	report("ft::map 5M finds", lookups(rb, probes));
+	report("ft::btree_map 1M scans of 100", scans(bt, keys, 1000000));
+	report("ft::map 1M scans of 100", scans(rb, keys, 1000000));
+}
+
+/*
+** hash: 4M random int keys, open-addressing table vs the rbtree map. The
+** slowest single insert shows what a rehash costs when it's spread over
+** later inserts instead of done at once.
+*/
+
+template <class Map>
+void timed_inserts(const char *what, Map &m, const std::vector<int> &keys)
+{
+	double worst = 0;
+	clock_t start = clock();
+	for (std::size_t i = 0; i < keys.size(); i++)
+	{
+		clock_t t = clock();
+		m.insert(ft::make_pair(keys[i], (int)i));
+		double s = seconds(t);
+		if (s > worst)
+			worst = s;
+	}
+	double total = seconds(start);
+	std::cout << "  " << std::left << std::setw(40) << what << std::right << std::fixed
+			  << std::setprecision(3) << total << " s  slowest " << std::setprecision(1)
+			  << worst * 1e6 << " us" << std::endl;
+}
+
+static void bench_hash()
+{
+	const int count = 4000000;
+	std::vector<int> keys;
+	srand(42);
+	for (int i = 0; i < count; i++)
+		keys.push_back(rand());
+	ft::unordered_map<int, int> hm;
+	ft::map<int, int> rb;
+	std::cout << "hash: " << count << " random int keys" << std::endl;
+	timed_inserts("ft::unordered_map insert", hm, keys);
+	timed_inserts("ft::map insert", rb, keys);
+	std::vector<int> probes(keys.begin(), keys.begin() + 1000000);
+	report("ft::unordered_map 5M finds", lookups(hm, probes));
+	report("ft::map 5M finds", lookups(rb, probes));
+	clock_t start = clock();
+	hm.reserve(hm.size() * 2);
+	report("the same growth done at once (reserve)", seconds(start));
+}
+
+/*
+** concurrent: 2M operations (80% find, 10% insert, 10% erase of random
+** keys, half of them present) split over 1, 2, 4... threads up to the
+** number of cores, on the lock-free skip list vs ft::map behind one mutex
+*/
+
+static double wall()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+struct locked_map
+{
+	locked_map() { pthread_mutex_init(&lock, NULL); }
+	~locked_map() { pthread_mutex_destroy(&lock); }
+	void insert(const ft::pair<const int, int> &v)
+	{
+		pthread_mutex_lock(&lock);
+		m.insert(v);
+		pthread_mutex_unlock(&lock);
+	}
+	void erase(int k)
+	{
+		pthread_mutex_lock(&lock);
+		m.erase(k);
+		pthread_mutex_unlock(&lock);
+	}
+	std::size_t count(int k)
+	{
+		pthread_mutex_lock(&lock);
+		std::size_t n = m.count(k);
+		pthread_mutex_unlock(&lock);
+		return n;
+	}
+	pthread_mutex_t lock;
+	ft::map<int, int, std::less<int>, std::allocator<ft::pair<const int, int> > > m;
+};
+
+template <class Map>
+struct mixed_ops
+{
+	Map *m;
+	int ops;
+	unsigned seed;
+
+	static void *run(void *arg)
+	{
+		mixed_ops *w = static_cast<mixed_ops *>(arg);
+		unsigned s = w->seed, found = 0;
+		for (int i = 0; i < w->ops; i++)
+		{
+			s = s * 1103515245 + 12345;
+			int k = (s >> 4) % 200000, r = (s >> 24) % 10;
+			if (r == 0)
+				w->m->insert(ft::make_pair(k, i));
+			else if (r == 1)
+				w->m->erase(k);
+			else
+				found += w->m->count(k);
+		}
+		g_sink = found;
+		return NULL;
+	}
+};
+
+template <class Map>
+double threaded_ops(int threads, int total)
+{
+	Map m;
+	for (int k = 0; k < 200000; k += 2)
+		m.insert(ft::make_pair(k, k));
+	std::vector<pthread_t> ids(threads);
+	std::vector<mixed_ops<Map> > work(threads);
+	double start = wall();
+	for (int i = 0; i < threads; i++)
+	{
+		work[i].m = &m;
+		work[i].ops = total / threads;
+		work[i].seed = i + 1;
+		pthread_create(&ids[i], NULL, mixed_ops<Map>::run, &work[i]);
+	}
+	for (int i = 0; i < threads; i++)
+		pthread_join(ids[i], NULL);
+	return wall() - start;
+}
+
+static void bench_concurrent()
+{
+	const int total = 2000000;
+	int cores = sysconf(_SC_NPROCESSORS_ONLN);
+	std::cout << "concurrent: " << total << " mixed ops over 100K keys, " << cores << " cores" << std::endl;
+	for (int t = 1; t <= cores; t = t * 2 > cores && t < cores ? cores : t * 2)
+	{
+		std::ostringstream what;
+		what << t << " thread" << (t > 1 ? "s" : "");
+		report(("ft::concurrent_map, " + what.str()).c_str(), threaded_ops<ft::concurrent_map<int, int> >(t, total));
+		report(("ft::map + mutex, " + what.str()).c_str(), threaded_ops<locked_map>(t, total));
+	}
+}
+
+template <std::size_t Shards>
+void sharded_ops(int threads, int total)
+{
+	std::ostringstream what;
+	what << Shards << " shard" << (Shards > 1 ? "s, " : ", ") << threads << " thread" << (threads > 1 ? "s" : "");
+	report(("ft::sharded_map, " + what.str()).c_str(),
+		   threaded_ops<ft::sharded_map<int, int, std::less<int>, Shards> >(threads, total));
+}
+
+static void bench_sharded()
+{
+	const int total = 2000000;
+	int cores = sysconf(_SC_NPROCESSORS_ONLN);
+	std::cout << "sharded: " << total << " mixed ops over 100K keys, " << cores << " cores" << std::endl;
+	for (int t = 1; t <= cores; t = t * 2 > cores && t < cores ? cores : t * 2)
+	{
+		sharded_ops<1>(t, total);
+		sharded_ops<4>(t, total);
+		sharded_ops<16>(t, total);
+		sharded_ops<64>(t, total);
+	}
+}
+
+/*
+** snapshot: a reader's consistent view of a map under updates, by copying
+** the whole map vs a path-copying persistent map
+*/
+
+template <class Map>
+void churn(Map &m, int count, int updates)
+{
+	for (int i = 0; i < updates; i++)
+	{
+		m.erase(rand() % (count * 2));
+		m.insert(ft::make_pair(rand() % (count * 2), i));
+	}
+}
+
+static double copied_snapshots(int count, int snapshots, int updates, bool take)
+{
+	clock_t start = clock();
+	ft::map<int, int> m;
+	for (int i = 0; i < count; i++)
+		m.insert(ft::make_pair(i * 2, i));
+	std::size_t sum = 0;
+	for (int s = 0; s < snapshots; s++)
+		if (take)
+		{
+			ft::map<int, int> view(m);
+			churn(m, count, updates);
+			sum += view.size();
+		}
+		else
+			churn(m, count, updates);
+	g_sink = sum;
+	return seconds(start);
+}
+
+static double persistent_snapshots(int count, int snapshots, int updates, bool take)
+{
+	clock_t start = clock();
+	ft::persistent_map<int, int> m;
+	for (int i = 0; i < count; i++)
+		m.insert(ft::make_pair(i * 2, i));
+	std::size_t sum = 0;
+	for (int s = 0; s < snapshots; s++)
+		if (take)
+		{
+			ft::persistent_map<int, int>::snapshot view = m.get_snapshot();
+			churn(m, count, updates);
+			sum += view.size();
+		}
+		else
+			churn(m, count, updates);
+	g_sink = sum;
+	return seconds(start);
+}
+
+static void bench_snapshot()
+{
+	const int count = 100000, snapshots = 200, updates = 100;
+	std::cout << "snapshot: " << count << " keys, " << snapshots << " snapshots " << updates
+			  << " erase/insert pairs apart" << std::endl;
+	srand(42);
+	report("ft::map, copied", copied_snapshots(count, snapshots, updates, true));
+	srand(42);
+	report("ft::persistent_map", persistent_snapshots(count, snapshots, updates, true));
+	srand(42);
+	report("ft::map, updates only", copied_snapshots(count, snapshots, updates, false));
+	srand(42);
+	report("ft::persistent_map, updates only", persistent_snapshots(count, snapshots, updates, false));
+}
+
+/*
+** parallel: copying and freeing a big map on one thread vs all the cores,
+** and how long clear() keeps the caller when the freeing is handed off
+*/
+
+typedef ft::map<int, int, std::less<int>, std::allocator<ft::pair<const int, int> > > big_map;
+
+static void bench_parallel()
+{
+	const int count = 4000000;
+	unsigned cores = ft::hardware_threads();
+	std::cout << "parallel: " << count << " keys, " << cores << " cores" << std::endl;
+	big_map m;
+	for (int i = 0; i < count; i++)
+		m.insert(m.end(), ft::make_pair(i, i));
+	double start = wall();
+	{
+		big_map copy(m);
+		report("copy", wall() - start);
+		start = wall();
+	}
+	report("destroy", wall() - start);
+	big_map copy;
+	start = wall();
+	copy.assign_parallel(m);
+	report("assign_parallel", wall() - start);
+	start = wall();
+	copy.clear_parallel();
+	report("clear_parallel", wall() - start);
+	copy = m;
+	copy.set_background_free(true);
+	start = wall();
+	copy.clear();
+	report("clear, background free", wall() - start);
+	// the default pool_allocator: a pool per thread, spliced into the copy's
+	ft::map<int, int> pm(m.begin(), m.end()), pcopy;
+	start = wall();
+	{
+		ft::map<int, int> serial(pm);
+		report("copy, pool_allocator", wall() - start);
+	}
+	start = wall();
+	pcopy.assign_parallel(pm);
+	report("assign_parallel, pool_allocator", wall() - start);
+}
+
+/*
+** workqueue: producers handing ints to as many consumers, through a
+** mutex-wrapped ft::stack, the Treiber stack and the bounded MPMC ring,
+** one item per call or in batches of 32
+*/
+
+struct locked_stack
+{
+	locked_stack() { pthread_mutex_init(&lock, NULL); }
+	~locked_stack() { pthread_mutex_destroy(&lock); }
+	pthread_mutex_t lock;
+	ft::stack<int> s;
+};
+
+static void put(locked_stack &q, const int *first, const int *last)
+{
+	pthread_mutex_lock(&q.lock);
+	for (; first != last; ++first)
+		q.s.push(*first);
+	pthread_mutex_unlock(&q.lock);
+}
+static std::size_t take(locked_stack &q, int *out, std::size_t n)
+{
+	std::size_t k = 0;
+	pthread_mutex_lock(&q.lock);
+	for (; k < n && !q.s.empty(); k++)
+	{
+		out[k] = q.s.top();
+		q.s.pop();
+	}
+	pthread_mutex_unlock(&q.lock);
+	return k;
+}
+static void put(ft::concurrent_stack<int> &q, const int *first, const int *last) { q.push(first, last); }
+static std::size_t take(ft::concurrent_stack<int> &q, int *out, std::size_t n) { return q.pop(out, n); }
+static void put(ft::mpmc_queue<int> &q, const int *first, const int *last)
+{
+	while ((first = q.push(first, last)) != last)
+		sched_yield();
+}
+static std::size_t take(ft::mpmc_queue<int> &q, int *out, std::size_t n) { return q.pop(out, n); }
+
+template <class Queue>
+struct handoff
+{
+	Queue *q;
+	int items;
+	int batch;
+	int *taken;
+	int total;
+
+	static void *produce(void *arg)
+	{
+		handoff *h = static_cast<handoff *>(arg);
+		int buf[32];
+		for (int i = 0; i < h->items; i += h->batch)
+		{
+			int n = std::min(h->batch, h->items - i);
+			for (int j = 0; j < n; j++)
+				buf[j] = i + j;
+			put(*h->q, buf, buf + n);
+		}
+		return NULL;
+	}
+	static void *consume(void *arg)
+	{
+		handoff *h = static_cast<handoff *>(arg);
+		int buf[32], sum = 0;
+		while (__atomic_load_n(h->taken, __ATOMIC_RELAXED) < h->total)
+		{
+			std::size_t n = take(*h->q, buf, h->batch);
+			if (!n)
+				sched_yield();
+			for (std::size_t j = 0; j < n; j++)
+				sum += buf[j];
+			__atomic_add_fetch(h->taken, int(n), __ATOMIC_RELAXED);
+		}
+		g_sink = sum;
+		return NULL;
+	}
+};
+
+template <class Queue>
+double producers_consumers(Queue &q, int pairs, int total, int batch)
+{
+	std::vector<pthread_t> ids(pairs * 2);
+	int taken = 0;
+	handoff<Queue> h = {&q, total / pairs, batch, &taken, total / pairs * pairs};
+	double start = wall();
+	for (int i = 0; i < pairs; i++)
+	{
+		pthread_create(&ids[i * 2], NULL, handoff<Queue>::produce, &h);
+		pthread_create(&ids[i * 2 + 1], NULL, handoff<Queue>::consume, &h);
+	}
+	for (int i = 0; i < pairs * 2; i++)
+		pthread_join(ids[i], NULL);
+	return wall() - start;
+}
+
+static void bench_workqueue()
+{
+	const int total = 4000000;
+	int cores = sysconf(_SC_NPROCESSORS_ONLN);
+	int pairs = cores > 1 ? cores / 2 : 1;
+	std::cout << "workqueue: " << total << " ints, " << pairs << " producer(s), " << pairs
+			  << " consumer(s), " << cores << " cores" << std::endl;
+	for (int batch = 1; batch <= 32; batch *= 32)
+	{
+		std::ostringstream what;
+		what << ", batch " << batch;
+		locked_stack ls;
+		report(("ft::stack + mutex" + what.str()).c_str(), producers_consumers(ls, pairs, total, batch));
+		ft::concurrent_stack<int> cs;
+		report(("ft::concurrent_stack" + what.str()).c_str(), producers_consumers(cs, pairs, total, batch));
+		ft::mpmc_queue<int> mq(1024);
+		report(("ft::mpmc_queue" + what.str()).c_str(), producers_consumers(mq, pairs, total, batch));
+	}
+}
+
+/*
+** stack: a deep stack of 4 KB buffers (main.cpp's Buffer), pushed then
+** popped, over ft::vector, ft::deque and std::deque; peak = max live / data
+*/
+
+template <class Stack>
+void stack_footprint(const char *what, int count)
+{
+	g_live = 0;
+	g_peak = 0;
+	clock_t start = clock();
+	{
+		Stack s;
+		Buffer b;
+		b.idx = 0;
+		for (int i = 0; i < count; i++)
+		{
+			b.idx = i;
+			s.push(b);
+		}
+		int sum = 0;
+		while (!s.empty())
+		{
+			sum += s.top().idx;
+			s.pop();
+		}
+		g_sink = sum;
+	}
+	double t = seconds(start);
+	std::cout << "  " << std::left << std::setw(40) << what << std::right << std::fixed << std::setprecision(3)
+			  << t << " s  peak " << std::setprecision(2) << double(g_peak) / (double(count) * sizeof(Buffer))
+			  << "x" << std::endl;
+}
+
+static void bench_stack()
+{
+	const int count = 20000;
+	std::cout << "stack: push then pop " << count << " Buffers of " << sizeof(Buffer) << " bytes" << std::endl;
+	stack_footprint<ft::stack<Buffer, ft::vector<Buffer, counting_allocator<Buffer> > > >("ft::stack over ft::vector (default)", count);
+	stack_footprint<ft::stack<Buffer, ft::deque<Buffer, counting_allocator<Buffer> > > >("ft::stack over ft::deque", count);
+	stack_footprint<std::stack<Buffer, std::deque<Buffer, counting_allocator<Buffer> > > >("std::stack over std::deque", count);
+}
+
+int main(int argc, char **argv)
+{
+	const char *only = argc > 1 ? argv[1] : NULL;
+	if (!only || !strcmp(only, "pool"))
+		bench_pool();
+	if (!only || !strcmp(only, "vector"))
+		bench_vector();
+	if (!only || !strcmp(only, "growth"))
+		bench_growth();
+	if (!only || !strcmp(only, "bulk"))
+		bench_bulk();
+	if (!only || !strcmp(only, "append"))
+		bench_append();
+	if (!only || !strcmp(only, "range"))
+		bench_range();
+	if (!only || !strcmp(only, "algebra"))
+		bench_algebra();
+	if (!only || !strcmp(only, "flat"))
+		bench_flat();
+	if (!only || !strcmp(only, "btree"))
+		bench_btree();
+	if (!only || !strcmp(only, "hash"))
+		bench_hash();
+	if (!only || !strcmp(only, "concurrent"))
+		bench_concurrent();
+	if (!only || !strcmp(only, "sharded"))
+		bench_sharded();
+	if (!only || !strcmp(only, "snapshot"))
+		bench_snapshot();
+	if (!only || !strcmp(only, "parallel"))
+		bench_parallel();
+	if (!only || !strcmp(only, "workqueue"))
+		bench_workqueue();
+	if (!only || !strcmp(only, "stack"))
+		bench_stack();
+	return (0);
+}
@@ -0,0 +1,743 @@
+#pragma once
+#include <cstring>
+#include <memory>
+#include <new>
+#include "pair.hpp"
+#include "functional.hpp"
+#include "reverse_iterator.hpp"
+#include "uninitialized.hpp"
+
+namespace ft
+{
+	template <class Value, class Compare = std::less<Value>,
+			  class Allocator = std::allocator<Value>,
+			  class KeyOf = ft::identity<Value> >
+	class btree;
+}
+
+/*
+** B+-tree: values live only in the leaves, which are chained both ways so
+** scans walk arrays; inner nodes hold copies of separator keys and child
+** pointers. A node spans NODE_BYTES (four cache lines), which with int keys
+** is ~20 children per inner node, so a lookup among 10M keys visits about
+** six nodes and searches each one's contiguous keys, where rbtree chases
+** ~25 scattered nodes.
+** Nodes are searched with the path to the leaf kept on the stack (no parent
+** pointers). Inserting or erasing moves values between slots and nodes, so
+** unlike rbtree both invalidate iterators and references.
+*/
+template <class Value, class Compare, class Allocator, class KeyOf>
+class ft::btree
+{
+public:
+	typedef std::size_t size_type;
+	typedef typename KeyOf::type key_type;
+	typedef typename remove_const<key_type>::type separator;
+
+	enum
+	{
+		NODE_BYTES = 256,
+		LEAF_SLOTS = (NODE_BYTES - 3 * sizeof(void *)) / sizeof(Value) > 4 ?
+			(NODE_BYTES - 3 * sizeof(void *)) / sizeof(Value) : 4,
+		INNER_SLOTS = (NODE_BYTES - 2 * sizeof(void *)) / (sizeof(separator) + sizeof(void *)) > 4 ?
+			(NODE_BYTES - 2 * sizeof(void *)) / (sizeof(separator) + sizeof(void *)) : 4,
+		MAX_HEIGHT = 64
+	};
+
+	// values in a leaf, separators in an inner node
+	struct node
+	{
+		unsigned short count;
+	};
+	struct leaf_node : node
+	{
+		leaf_node() : prev(NULL), next(NULL) { this->count = 0; }
+		leaf_node *prev;
+		leaf_node *next;
+		char slots[LEAF_SLOTS * sizeof(Value)] __attribute__((aligned(__alignof__(Value))));
+		Value *values() { return reinterpret_cast<Value *>(slots); }
+	};
+	// child[i] holds the keys in [seps()[i - 1], seps()[i])
+	struct inner_node : node
+	{
+		inner_node() { this->count = 0; }
+		node *child[INNER_SLOTS + 1];
+		char keys[INNER_SLOTS * sizeof(separator)] __attribute__((aligned(__alignof__(separator))));
+		separator *seps() { return reinterpret_cast<separator *>(keys); }
+	};
+
+	/*
+	** A leaf and a slot in it. Only the last leaf's iterator may sit one
+	** past its values: that's end(). (NULL, 0) is end() of an empty tree.
+	*/
+	class const_iterator
+	{
+	public:
+		typedef typename Allocator::difference_type difference_type;
+		typedef Value value_type;
+		typedef const Value &reference;
+		typedef const Value *pointer;
+		typedef std::bidirectional_iterator_tag iterator_category;
+
+		const_iterator() : _leaf(NULL), _pos(0) {}
+		const_iterator(leaf_node *leaf, size_type pos) : _leaf(leaf), _pos(pos)
+		{
+			if (_leaf && _pos == _leaf->count && _leaf->next)
+			{
+				_leaf = _leaf->next;
+				_pos = 0;
+			}
+		}
+		const_iterator(const const_iterator &other) : _leaf(other._leaf), _pos(other._pos) {}
+		~const_iterator() {}
+
+		const_iterator &operator=(const const_iterator &other)
+		{
+			_leaf = other._leaf;
+			_pos = other._pos;
+			return *this;
+		}
+		bool operator==(const const_iterator &other) const { return _leaf == other._leaf && _pos == other._pos; }
+		bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+		const_iterator &operator++()
+		{
+			if (++_pos == _leaf->count && _leaf->next)
+			{
+				_leaf = _leaf->next;
+				_pos = 0;
+			}
+			return *this;
+		}
+		const_iterator operator++(int)
+		{
+			const_iterator t(*this);
+			++*this;
+			return t;
+		}
+		const_iterator &operator--()
+		{
+			if (!_pos)
+			{
+				_leaf = _leaf->prev;
+				_pos = _leaf->count;
+			}
+			--_pos;
+			return *this;
+		}
+		const_iterator operator--(int)
+		{
+			const_iterator t(*this);
+			--*this;
+			return t;
+		}
+
+		reference operator*() const { return _leaf->values()[_pos]; }
+		pointer operator->() const { return _leaf->values() + _pos; }
+		leaf_node *_leaf;
+		size_type _pos;
+	};
+
+	class iterator : public const_iterator
+	{
+	private:
+		typedef const_iterator cit;
+
+	public:
+		typedef typename Allocator::difference_type difference_type;
+		typedef Value value_type;
+		typedef Value &reference;
+		typedef Value *pointer;
+		typedef std::bidirectional_iterator_tag iterator_category;
+
+		iterator() : cit() {}
+		iterator(leaf_node *leaf, size_type pos) : cit(leaf, pos) {}
+		iterator(const iterator &other) : cit(other) {}
+		~iterator() {}
+
+		iterator &operator=(const iterator &other)
+		{
+			cit::operator=(other);
+			return *this;
+		}
+		iterator &operator++()
+		{
+			cit::operator++();
+			return *this;
+		}
+		iterator operator++(int)
+		{
+			iterator t(*this);
+			cit::operator++();
+			return t;
+		}
+		iterator &operator--()
+		{
+			cit::operator--();
+			return *this;
+		}
+		iterator operator--(int)
+		{
+			iterator t(*this);
+			cit::operator--();
+			return t;
+		}
+
+		reference operator*() const { return cit::_leaf->values()[cit::_pos]; }
+		pointer operator->() const { return cit::_leaf->values() + cit::_pos; }
+	};
+
+	typedef ft::reverse_iterator<iterator> reverse_iterator;
+	typedef ft::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	iterator begin() { return iterator(_first, 0); }
+	const_iterator begin() const { return const_iterator(_first, 0); }
+	iterator end() { return iterator(_last, _last ? _last->count : 0); }
+	const_iterator end() const { return const_iterator(_last, _last ? _last->count : 0); }
+	reverse_iterator rbegin() { return reverse_iterator(end()); }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+	reverse_iterator rend() { return reverse_iterator(begin()); }
+	const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+	btree() : _root(NULL), _first(NULL), _last(NULL), _size(0), _height(0) {}
+	btree(const Compare &comp, const Allocator &alloc) : _root(NULL),
+														 _first(NULL),
+														 _last(NULL),
+														 _size(0),
+														 _height(0),
+														 _comp(comp),
+														 _alloc(alloc),
+														 _sep_alloc(alloc),
+														 _leaf_alloc(alloc),
+														 _inner_alloc(alloc) {}
+	btree(const btree &other) : _root(NULL),
+								_first(NULL),
+								_last(NULL),
+								_size(0),
+								_height(0),
+								_comp(other._comp),
+								_alloc(allocator_copy<value_allocator>::select(other._alloc)),
+								_sep_alloc(_alloc),
+								_leaf_alloc(_alloc),
+								_inner_alloc(_alloc)
+	{
+		copy_from(other);
+	}
+	~btree() { clear(); }
+	btree &operator=(const btree &other)
+	{
+		if (this == &other)
+			return *this;
+		clear();
+		copy_from(other);
+		return *this;
+	}
+
+	bool empty() const { return !_size; }
+	size_type size() const { return _size; }
+	size_type max_size() const { return _alloc.max_size(); }
+	void clear()
+	{
+		if (_root)
+			free_node(_root, _height);
+		_root = NULL;
+		_first = _last = NULL;
+		_size = 0;
+		_height = 0;
+	}
+	void swap(btree &other)
+	{
+		std::swap(_root, other._root);
+		std::swap(_first, other._first);
+		std::swap(_last, other._last);
+		std::swap(_size, other._size);
+		std::swap(_height, other._height);
+		std::swap(_comp, other._comp);
+		std::swap(_alloc, other._alloc);
+		std::swap(_sep_alloc, other._sep_alloc);
+		std::swap(_leaf_alloc, other._leaf_alloc);
+		std::swap(_inner_alloc, other._inner_alloc);
+	}
+
+	pair<iterator, bool> insert(const Value &value)
+	{
+		copy_value make = {value};
+		return insert_unique(KeyOf()(value), make);
+	}
+	/*
+	** make(p) constructs the value at p; it only runs once key is known to
+	** be new, so e.g. a map's mapped value is never built for nothing.
+	*/
+	template <class Make>
+	pair<iterator, bool> insert_unique(const key_type &key, const Make &make)
+	{
+		if (!_root)
+		{
+			leaf_node *l = new_leaf();
+			try { make(l->values()); }
+			catch (...) { free_leaf(l); throw; }
+			l->count = 1;
+			_root = _first = _last = l;
+			_size = 1;
+			return make_pair(iterator(l, 0), true);
+		}
+		step path[MAX_HEIGHT];
+		leaf_node *l;
+		size_type pos;
+		if (_comp(key_of(_last->values()[_last->count - 1]), key))
+		{
+			// past the largest key: straight down the right edge
+			l = rightmost(path);
+			pos = l->count;
+		}
+		else
+		{
+			l = descend(key, path);
+			pos = lower_index(l, key);
+			if (pos < l->count && !_comp(key, key_of(l->values()[pos])))
+				return make_pair(iterator(l, pos), false);
+		}
+		if (l->count == LEAF_SLOTS)
+			split_leaf(l, pos, path);
+		Value *v = l->values();
+		values::relocate(_alloc, v + pos + 1, v + pos, l->count - pos);
+		try { make(v + pos); }
+		catch (...)
+		{
+			values::relocate(_alloc, v + pos, v + pos + 1, l->count - pos);
+			throw;
+		}
+		++l->count;
+		++_size;
+		return make_pair(iterator(l, pos), true);
+	}
+	template <class InputIt>
+	void insert_range(InputIt first, InputIt last)
+	{
+		for (; first != last; ++first)
+			insert(*first);
+	}
+	// returns the element that followed pos
+	iterator erase(const_iterator pos)
+	{
+		step path[MAX_HEIGHT];
+		leaf_node *l = descend(key_of(*pos), path);
+		return erase_at(l, pos._pos, path);
+	}
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		size_type n = 0;
+		for (const_iterator it = first; it != last; ++it)
+			++n;
+		iterator it(first._leaf, first._pos);
+		while (n--)
+			it = erase(it);
+		return it;
+	}
+	template <class K>
+	size_type erase_key(const K &key)
+	{
+		if (!_root)
+			return 0;
+		step path[MAX_HEIGHT];
+		leaf_node *l = descend(key, path);
+		size_type pos = lower_index(l, key);
+		if (pos == l->count || _comp(key, key_of(l->values()[pos])))
+			return 0;
+		erase_at(l, pos, path);
+		return 1;
+	}
+
+	template <class K>
+	iterator find(const K &key) const
+	{
+		iterator it = lower_bound(key);
+		if (it == end() || _comp(key, key_of(*it)))
+			return iterator(_last, _last ? _last->count : 0);
+		return it;
+	}
+	template <class K>
+	iterator lower_bound(const K &key) const
+	{
+		if (!_root)
+			return iterator();
+		leaf_node *l = descend(key, NULL);
+		return iterator(l, lower_index(l, key));
+	}
+	template <class K>
+	iterator upper_bound(const K &key) const
+	{
+		if (!_root)
+			return iterator();
+		leaf_node *l = descend(key, NULL);
+		return iterator(l, upper_index(l, key));
+	}
+
+private:
+	typedef typename Allocator::template rebind<Value>::other value_allocator;
+	typedef typename Allocator::template rebind<separator>::other separator_allocator;
+	typedef typename Allocator::template rebind<leaf_node>::other leaf_allocator;
+	typedef typename Allocator::template rebind<inner_node>::other inner_allocator;
+	typedef uninitialized<Value, value_allocator> values;
+	typedef uninitialized<separator, separator_allocator> separators;
+
+	// an inner node passed on the way down and the child taken there
+	struct step
+	{
+		inner_node *node;
+		size_type index;
+	};
+	struct copy_value
+	{
+		const Value &value;
+		void operator()(Value *p) const { new (p) Value(value); }
+	};
+
+	node *_root;
+	leaf_node *_first;
+	leaf_node *_last;
+	size_type _size;
+	size_type _height; // inner levels above the leaves
+	Compare _comp;
+	value_allocator _alloc;
+	separator_allocator _sep_alloc;
+	leaf_allocator _leaf_alloc;
+	inner_allocator _inner_alloc;
+
+	static const key_type &key_of(const Value &v) { return KeyOf()(v); }
+
+	leaf_node *new_leaf()
+	{
+		leaf_node *l = _leaf_alloc.allocate(1);
+		return new (l) leaf_node();
+	}
+	inner_node *new_inner()
+	{
+		inner_node *in = _inner_alloc.allocate(1);
+		return new (in) inner_node();
+	}
+	void free_leaf(leaf_node *l) { _leaf_alloc.deallocate(l, 1); }
+	void free_inner(inner_node *in) { _inner_alloc.deallocate(in, 1); }
+	void free_node(node *n, size_type height)
+	{
+		if (!height)
+		{
+			leaf_node *l = static_cast<leaf_node *>(n);
+			values::destroy(_alloc, l->values(), l->values() + l->count);
+			return free_leaf(l);
+		}
+		inner_node *in = static_cast<inner_node *>(n);
+		for (size_type i = 0; i <= in->count; i++)
+			free_node(in->child[i], height - 1);
+		separators::destroy(_sep_alloc, in->seps(), in->seps() + in->count);
+		free_inner(in);
+	}
+	// in key order, so every insert takes the append path and leaves end up full
+	void copy_from(const btree &other)
+	{
+		try
+		{
+			for (const_iterator it = other.begin(); it != other.end(); ++it)
+				insert(*it);
+		}
+		catch (...)
+		{
+			clear();
+			throw;
+		}
+	}
+
+	// the leaf where key belongs, recording the way down in path
+	template <class K>
+	leaf_node *descend(const K &key, step *path) const
+	{
+		node *n = _root;
+		for (size_type d = 0; d < _height; d++)
+		{
+			inner_node *in = static_cast<inner_node *>(n);
+			size_type i = child_index(in, key);
+			if (path)
+			{
+				path[d].node = in;
+				path[d].index = i;
+			}
+			n = in->child[i];
+		}
+		return static_cast<leaf_node *>(n);
+	}
+	leaf_node *rightmost(step *path) const
+	{
+		node *n = _root;
+		for (size_type d = 0; d < _height; d++)
+		{
+			inner_node *in = static_cast<inner_node *>(n);
+			path[d].node = in;
+			path[d].index = in->count;
+			n = in->child[in->count];
+		}
+		return static_cast<leaf_node *>(n);
+	}
+	// first separator greater than key: keys equal to it sit to its right
+	template <class K>
+	size_type child_index(inner_node *in, const K &key) const
+	{
+		separator *s = in->seps();
+		size_type lo = 0, hi = in->count;
+		while (lo < hi)
+		{
+			size_type mid = (lo + hi) / 2;
+			if (_comp(key, s[mid]))
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		return lo;
+	}
+	template <class K>
+	size_type lower_index(leaf_node *l, const K &key) const
+	{
+		Value *v = l->values();
+		size_type lo = 0, hi = l->count;
+		while (lo < hi)
+		{
+			size_type mid = (lo + hi) / 2;
+			if (_comp(key_of(v[mid]), key))
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+	template <class K>
+	size_type upper_index(leaf_node *l, const K &key) const
+	{
+		Value *v = l->values();
+		size_type lo = 0, hi = l->count;
+		while (lo < hi)
+		{
+			size_type mid = (lo + hi) / 2;
+			if (_comp(key, key_of(v[mid])))
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		return lo;
+	}
+
+	/*
+	** Moves the upper half of the full leaf l to a new right sibling and
+	** updates l and pos to where the value being inserted goes. Appending
+	** past the last key moves only one value, so sorted input packs leaves
+	** instead of leaving them half empty.
+	*/
+	void split_leaf(leaf_node *&l, size_type &pos, step *path)
+	{
+		bool append = pos == LEAF_SLOTS && !l->next;
+		size_type keep = append ? LEAF_SLOTS - 1 : LEAF_SLOTS / 2;
+		leaf_node *r = new_leaf();
+		values::relocate(_alloc, r->values(), l->values() + keep, LEAF_SLOTS - keep);
+		r->count = LEAF_SLOTS - keep;
+		l->count = keep;
+		r->prev = l;
+		r->next = l->next;
+		if (l->next)
+			l->next->prev = r;
+		else
+			_last = r;
+		l->next = r;
+		insert_child(path, _height, key_of(r->values()[0]), r, append);
+		if (pos > keep)
+		{
+			l = r;
+			pos -= keep;
+		}
+	}
+	// adds sep and right after child path[depth - 1].index of path[depth - 1].node
+	void insert_child(step *path, size_type depth, const separator &sep, node *right, bool append)
+	{
+		if (!depth)
+		{
+			inner_node *root = new_inner();
+			try { separators::construct(_sep_alloc, root->seps(), sep); }
+			catch (...) { free_inner(root); throw; }
+			root->count = 1;
+			root->child[0] = _root;
+			root->child[1] = right;
+			_root = root;
+			++_height;
+			return;
+		}
+		inner_node *in = path[depth - 1].node;
+		size_type i = path[depth - 1].index;
+		if (in->count == INNER_SLOTS)
+			split_inner(in, i, path, depth, append);
+		separator *s = in->seps();
+		separators::relocate(_sep_alloc, s + i + 1, s + i, in->count - i);
+		try { separators::construct(_sep_alloc, s + i, sep); }
+		catch (...)
+		{
+			separators::relocate(_sep_alloc, s + i, s + i + 1, in->count - i);
+			throw;
+		}
+		std::memmove(in->child + i + 2, in->child + i + 1, (in->count - i) * sizeof(node *));
+		in->child[i + 1] = right;
+		++in->count;
+	}
+	// the inner-node counterpart of split_leaf; the middle separator moves up
+	void split_inner(inner_node *&in, size_type &i, step *path, size_type depth, bool append)
+	{
+		size_type mid = append ? INNER_SLOTS - 1 : INNER_SLOTS / 2;
+		inner_node *r = new_inner();
+		separator *s = in->seps();
+		separators::relocate(_sep_alloc, r->seps(), s + mid + 1, INNER_SLOTS - mid - 1);
+		std::memcpy(r->child, in->child + mid + 1, (INNER_SLOTS - mid) * sizeof(node *));
+		r->count = INNER_SLOTS - mid - 1;
+		in->count = mid;
+		insert_child(path, depth - 1, s[mid], r, append);
+		separators::destroy_at(_sep_alloc, s + mid);
+		if (i > mid)
+		{
+			in = r;
+			i -= mid + 1;
+		}
+	}
+
+	iterator erase_at(leaf_node *l, size_type pos, step *path)
+	{
+		Value *v = l->values();
+		values::destroy_at(_alloc, v + pos);
+		values::relocate(_alloc, v + pos, v + pos + 1, l->count - pos - 1);
+		--l->count;
+		--_size;
+		if (!_height && !l->count)
+		{
+			free_leaf(l);
+			_root = _first = _last = NULL;
+			return iterator();
+		}
+		if (_height && l->count < LEAF_SLOTS / 2)
+			rebalance_leaf(l, pos, path);
+		return iterator(l, pos);
+	}
+	/*
+	** Refills the underfull leaf l from a sibling that can spare a value, or
+	** merges it with one; pos follows the value it pointed at.
+	*/
+	void rebalance_leaf(leaf_node *&l, size_type &pos, step *path)
+	{
+		inner_node *p = path[_height - 1].node;
+		size_type i = path[_height - 1].index;
+		leaf_node *left = i > 0 ? static_cast<leaf_node *>(p->child[i - 1]) : NULL;
+		leaf_node *right = i < p->count ? static_cast<leaf_node *>(p->child[i + 1]) : NULL;
+		if (left && left->count > LEAF_SLOTS / 2)
+		{
+			values::relocate(_alloc, l->values() + 1, l->values(), l->count);
+			values::relocate(_alloc, l->values(), left->values() + left->count - 1, 1);
+			--left->count;
+			++l->count;
+			++pos;
+			p->seps()[i - 1] = key_of(l->values()[0]);
+		}
+		else if (right && right->count > LEAF_SLOTS / 2)
+		{
+			values::relocate(_alloc, l->values() + l->count, right->values(), 1);
+			values::relocate(_alloc, right->values(), right->values() + 1, right->count - 1);
+			--right->count;
+			++l->count;
+			p->seps()[i] = key_of(right->values()[0]);
+		}
+		else if (left)
+		{
+			pos += left->count;
+			merge_leaves(left, l);
+			l = left;
+			remove_child(path, _height, i - 1);
+		}
+		else
+		{
+			merge_leaves(l, right);
+			remove_child(path, _height, i);
+		}
+	}
+	void merge_leaves(leaf_node *l, leaf_node *r)
+	{
+		values::relocate(_alloc, l->values() + l->count, r->values(), r->count);
+		l->count += r->count;
+		l->next = r->next;
+		if (r->next)
+			r->next->prev = l;
+		else
+			_last = l;
+		free_leaf(r);
+	}
+	// drops separator i and the child right of it from path[depth - 1].node
+	void remove_child(step *path, size_type depth, size_type i)
+	{
+		inner_node *in = path[depth - 1].node;
+		separator *s = in->seps();
+		separators::destroy_at(_sep_alloc, s + i);
+		separators::relocate(_sep_alloc, s + i, s + i + 1, in->count - i - 1);
+		std::memmove(in->child + i + 1, in->child + i + 2, (in->count - i - 1) * sizeof(node *));
+		--in->count;
+		if (depth == 1)
+		{
+			if (!in->count)
+			{
+				_root = in->child[0];
+				free_inner(in);
+				--_height;
+			}
+		}
+		else if (in->count < INNER_SLOTS / 2)
+			rebalance_inner(path, depth - 1);
+	}
+	// rebalance_leaf for path[depth].node, rotating keys through the parent
+	void rebalance_inner(step *path, size_type depth)
+	{
+		inner_node *c = path[depth].node;
+		inner_node *p = path[depth - 1].node;
+		size_type i = path[depth - 1].index;
+		inner_node *left = i > 0 ? static_cast<inner_node *>(p->child[i - 1]) : NULL;
+		inner_node *right = i < p->count ? static_cast<inner_node *>(p->child[i + 1]) : NULL;
+		if (left && left->count > INNER_SLOTS / 2)
+		{
+			separators::relocate(_sep_alloc, c->seps() + 1, c->seps(), c->count);
+			std::memmove(c->child + 1, c->child, (c->count + 1) * sizeof(node *));
+			separators::construct(_sep_alloc, c->seps(), p->seps()[i - 1]);
+			c->child[0] = left->child[left->count];
+			p->seps()[i - 1] = left->seps()[left->count - 1];
+			separators::destroy_at(_sep_alloc, left->seps() + left->count - 1);
+			--left->count;
+			++c->count;
+		}
+		else if (right && right->count > INNER_SLOTS / 2)
+		{
+			separators::construct(_sep_alloc, c->seps() + c->count, p->seps()[i]);
+			c->child[c->count + 1] = right->child[0];
+			p->seps()[i] = right->seps()[0];
+			separators::destroy_at(_sep_alloc, right->seps());
+			separators::relocate(_sep_alloc, right->seps(), right->seps() + 1, right->count - 1);
+			std::memmove(right->child, right->child + 1, right->count * sizeof(node *));
+			--right->count;
+			++c->count;
+		}
+		else if (left)
+		{
+			merge_inner(left, c, p->seps()[i - 1]);
+			remove_child(path, depth, i - 1);
+		}
+		else
+		{
+			merge_inner(c, right, p->seps()[i]);
+			remove_child(path, depth, i);
+		}
+	}
+	void merge_inner(inner_node *l, inner_node *r, const separator &sep)
+	{
+		separators::construct(_sep_alloc, l->seps() + l->count, sep);
+		separators::relocate(_sep_alloc, l->seps() + l->count + 1, r->seps(), r->count);
+		std::memcpy(l->child + l->count + 1, r->child, (r->count + 1) * sizeof(node *));
+		l->count += r->count + 1;
+		free_inner(r);
+	}
+};
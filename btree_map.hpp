@@ -0,0 +1,274 @@
+#pragma once
+#include <stdexcept>
+#include "btree.hpp"
+
+namespace ft
+{
+	template <class Key, class T, class Compare = std::less<Key>,
+		class Allocator = std::allocator<pair<const Key, T> > >
+	class btree_map;
+}
+
+/*
+** ft::map over a B+-tree (see btree.hpp): same interface for lookup,
+** insertion and iteration, so the two switch by typedef, but
+** - insert and erase invalidate iterators and references, and
+**   erase(pos) returns the iterator that followed pos instead of void;
+** - iterators are bidirectional only, and the order statistics, range
+**   extraction and set algebra built on rbtree (nth, rank, count_range,
+**   extract_range, set_union...) are not provided.
+*/
+template <class Key, class T, class Compare, class Allocator>
+class ft::btree_map
+{
+public:
+	typedef Key key_type;
+	typedef T mapped_type;
+	typedef pair<const Key, T> value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef Compare key_compare;
+	typedef Allocator allocator_type;
+	typedef value_type& reference;
+	typedef const value_type& const_reference;
+	typedef typename Allocator::pointer pointer;
+	typedef typename Allocator::const_pointer const_pointer;
+
+	class value_compare
+	{
+	public:
+		typedef bool result_type;
+		typedef value_type first_argument_type;
+		typedef value_type second_argument_type;
+
+		value_compare() {}
+		bool operator()(const value_type &lhs, const value_type &rhs) const
+		{
+			return comp(lhs.first, rhs.first);
+		}
+
+	protected:
+		friend class btree_map;
+		value_compare(Compare c) : comp(c) {}
+		Compare comp;
+	};
+
+private:
+	typedef btree<value_type, Compare, Allocator, select_first<value_type> > tree;
+
+public:
+	typedef typename tree::iterator iterator;
+	typedef typename tree::const_iterator const_iterator;
+	typedef typename tree::reverse_iterator reverse_iterator;
+	typedef typename tree::const_reverse_iterator const_reverse_iterator;
+
+	iterator begin() { return _bt.begin(); }
+	const_iterator begin() const { return _bt.begin(); }
+	iterator end() { return _bt.end(); }
+	const_iterator end() const { return _bt.end(); }
+	reverse_iterator rbegin() { return _bt.rbegin(); }
+	const_reverse_iterator rbegin() const { return _bt.rbegin(); }
+	reverse_iterator rend() { return _bt.rend(); }
+	const_reverse_iterator rend() const { return _bt.rend(); }
+
+	btree_map() {}
+	explicit btree_map(const Compare &comp,
+					   const Allocator &alloc = Allocator()) : _alloc(alloc),
+															   _comp(comp),
+															   _bt(comp, alloc) {}
+	template <class InputIt>
+	btree_map(InputIt first, InputIt last,
+			  const Compare &comp = Compare(),
+			  const Allocator &alloc = Allocator()) : _alloc(alloc),
+													  _comp(comp),
+													  _bt(comp, alloc)
+	{
+		_bt.insert_range(first, last);
+	}
+	btree_map(const btree_map &other) : _alloc(allocator_copy<Allocator>::select(other._alloc)),
+										_comp(other._comp),
+										_bt(other._bt) {}
+	~btree_map() {}
+	btree_map &operator=(const btree_map &other)
+	{
+		if (this == &other)
+			return (*this);
+		_bt = other._bt;
+		return (*this);
+	}
+	allocator_type get_allocator() const { return _alloc; }
+
+	T &at(const Key &key)
+	{
+		iterator it = find(key);
+		if (it != end())
+			return it->second;
+		throw std::out_of_range("no element with key");
+	}
+	const T &at(const Key &key) const
+	{
+		const_iterator it = find(key);
+		if (it != end())
+			return it->second;
+		throw std::out_of_range("no element with key");
+	}
+	T &operator[](const Key &key) { return try_emplace(key).first->second; }
+	// the mapped value is only built (from arg, if given) for a new key
+	pair<iterator, bool> try_emplace(const Key &key)
+	{
+		make_default make = {key};
+		return _bt.insert_unique(key, make);
+	}
+	template <class A1>
+	pair<iterator, bool> try_emplace(const Key &key, const A1 &arg)
+	{
+		make_from<A1> make = {key, arg};
+		return _bt.insert_unique(key, make);
+	}
+	template <class M>
+	pair<iterator, bool> insert_or_assign(const Key &key, const M &obj)
+	{
+		pair<iterator, bool> r = try_emplace(key, obj);
+		if (!r.second)
+			r.first->second = obj;
+		return r;
+	}
+
+	bool empty() const { return _bt.empty(); }
+	size_type size() const { return _bt.size(); }
+	size_type max_size() const { return _bt.max_size(); }
+	void clear() { _bt.clear(); }
+	pair<iterator, bool> insert(const value_type &value) { return _bt.insert(value); }
+	iterator insert(iterator, const value_type &value) { return _bt.insert(value).first; }
+	template <class InputIt>
+	void insert(InputIt first, InputIt last)
+	{
+		_bt.insert_range(first, last);
+	}
+	iterator erase(iterator pos) { return _bt.erase(pos); }
+	iterator erase(iterator first, iterator last) { return _bt.erase(first, last); }
+	size_type erase(const key_type &key) { return _bt.erase_key(key); }
+	void swap(btree_map &other) { _bt.swap(other._bt); }
+
+	size_type count(const Key &key) const { return find(key) != end(); }
+	iterator find(const Key &key) { return _bt.find(key); }
+	const_iterator find(const Key &key) const { return _bt.find(key); }
+	pair<iterator, iterator> equal_range(const Key &key)
+	{
+		return make_pair(_bt.lower_bound(key), _bt.upper_bound(key));
+	}
+	pair<const_iterator, const_iterator> equal_range(const Key &key) const
+	{
+		return make_pair(const_iterator(_bt.lower_bound(key)), const_iterator(_bt.upper_bound(key)));
+	}
+	iterator lower_bound(const Key &key) { return _bt.lower_bound(key); }
+	const_iterator lower_bound(const Key &key) const { return _bt.lower_bound(key); }
+	iterator upper_bound(const Key &key) { return _bt.upper_bound(key); }
+	const_iterator upper_bound(const Key &key) const { return _bt.upper_bound(key); }
+
+	// heterogeneous lookup, for a Compare that defines is_transparent
+	template <class K>
+	typename enable_if_transparent<Compare, K, size_type>::type
+	count(const K &key) const { return find(key) != end(); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	find(const K &key) { return _bt.find(key); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, const_iterator>::type
+	find(const K &key) const { return _bt.find(key); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, pair<iterator, iterator> >::type
+	equal_range(const K &key)
+	{
+		return make_pair(_bt.lower_bound(key), _bt.upper_bound(key));
+	}
+	template <class K>
+	typename enable_if_transparent<Compare, K, pair<const_iterator, const_iterator> >::type
+	equal_range(const K &key) const
+	{
+		return make_pair(const_iterator(_bt.lower_bound(key)), const_iterator(_bt.upper_bound(key)));
+	}
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	lower_bound(const K &key) { return _bt.lower_bound(key); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, const_iterator>::type
+	lower_bound(const K &key) const { return _bt.lower_bound(key); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	upper_bound(const K &key) { return _bt.upper_bound(key); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, const_iterator>::type
+	upper_bound(const K &key) const { return _bt.upper_bound(key); }
+
+	key_compare key_comp() const { return _comp; }
+	value_compare value_comp() const { return value_compare(_comp); }
+
+private:
+	struct make_default
+	{
+		const Key &key;
+		void operator()(value_type *p) const { new (p) value_type(key, T()); }
+	};
+	template <class A1>
+	struct make_from
+	{
+		const Key &key;
+		const A1 &arg;
+		void operator()(value_type *p) const { new (p) value_type(key, arg); }
+	};
+
+	Allocator _alloc;
+	Compare _comp;
+	tree _bt;
+};
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator==(const ft::btree_map<Key, T, Compare, Alloc> &lhs,
+				const ft::btree_map<Key, T, Compare, Alloc> &rhs)
+{
+	if (lhs.size() != rhs.size())
+		return false;
+	typename ft::btree_map<Key, T, Compare, Alloc>::const_iterator itl = lhs.begin();
+	typename ft::btree_map<Key, T, Compare, Alloc>::const_iterator itr = rhs.begin();
+	while (itl != lhs.end() && *itl == *itr)
+	{
+		++itl;
+		++itr;
+	}
+	return (itl == lhs.end());
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator!=(const ft::btree_map<Key, T, Compare, Alloc> &lhs,
+				const ft::btree_map<Key, T, Compare, Alloc> &rhs) { return (!(lhs == rhs)); }
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator<(const ft::btree_map<Key, T, Compare, Alloc> &lhs,
+			   const ft::btree_map<Key, T, Compare, Alloc> &rhs)
+{
+	typename ft::btree_map<Key, T, Compare, Alloc>::const_iterator itl = lhs.begin();
+	typename ft::btree_map<Key, T, Compare, Alloc>::const_iterator itr = rhs.begin();
+	while (itl != lhs.end() && itr != rhs.end() && *itl == *itr)
+	{
+		++itl;
+		++itr;
+	}
+	return (itl == lhs.end() && itr != rhs.end()) || (itl != lhs.end() && itr != rhs.end() && *itl < *itr);
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator<=(const ft::btree_map<Key, T, Compare, Alloc> &lhs,
+				const ft::btree_map<Key, T, Compare, Alloc> &rhs) { return (!(rhs < lhs)); }
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator>(const ft::btree_map<Key, T, Compare, Alloc> &lhs,
+			   const ft::btree_map<Key, T, Compare, Alloc> &rhs) { return (rhs < lhs); }
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator>=(const ft::btree_map<Key, T, Compare, Alloc> &lhs,
+				const ft::btree_map<Key, T, Compare, Alloc> &rhs) { return (!(lhs < rhs)); }
+
+template <class Key, class T, class Compare, class Alloc>
+void swap(ft::btree_map<Key, T, Compare, Alloc> &lhs,
+		  ft::btree_map<Key, T, Compare, Alloc> &rhs) { lhs.swap(rhs); }
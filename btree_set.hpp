@@ -0,0 +1,175 @@
+#pragma once
+#include "btree.hpp"
+
+namespace ft
+{
+	template <class Key, class Compare = std::less<Key>,
+			  class Allocator = std::allocator<Key> >
+	class btree_set;
+}
+
+// ft::set over a B+-tree, with the same differences as btree_map
+template <class Key, class Compare, class Allocator>
+class ft::btree_set
+{
+public:
+	typedef Key key_type;
+	typedef Key value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef Compare key_compare;
+	typedef Compare value_compare;
+	typedef Allocator allocator_type;
+	typedef value_type &reference;
+	typedef const value_type &const_reference;
+	typedef typename Allocator::pointer pointer;
+	typedef typename Allocator::const_pointer const_pointer;
+
+private:
+	typedef btree<value_type, value_compare, Allocator> tree;
+
+public:
+	typedef typename tree::const_iterator iterator;
+	typedef typename tree::const_iterator const_iterator;
+	typedef typename tree::const_reverse_iterator reverse_iterator;
+	typedef typename tree::const_reverse_iterator const_reverse_iterator;
+
+	iterator begin() const { return _bt.begin(); }
+	iterator end() const { return _bt.end(); }
+	reverse_iterator rbegin() const { return _bt.rbegin(); }
+	reverse_iterator rend() const { return _bt.rend(); }
+
+	btree_set() {}
+	explicit btree_set(const Compare &comp,
+					   const Allocator &alloc = Allocator()) : _alloc(alloc),
+															   _comp(comp),
+															   _bt(comp, alloc) {}
+	template <class InputIt>
+	btree_set(InputIt first, InputIt last,
+			  const Compare &comp = Compare(),
+			  const Allocator &alloc = Allocator()) : _alloc(alloc),
+													  _comp(comp),
+													  _bt(comp, alloc)
+	{
+		_bt.insert_range(first, last);
+	}
+	btree_set(const btree_set &other) : _alloc(allocator_copy<Allocator>::select(other._alloc)),
+										_comp(other._comp),
+										_bt(other._bt) {}
+	~btree_set() {}
+	btree_set &operator=(const btree_set &other)
+	{
+		if (this == &other)
+			return (*this);
+		_bt = other._bt;
+		return (*this);
+	}
+	allocator_type get_allocator() const { return _alloc; }
+
+	bool empty() const { return _bt.empty(); }
+	size_type size() const { return _bt.size(); }
+	size_type max_size() const { return _bt.max_size(); }
+	void clear() { _bt.clear(); }
+	pair<iterator, bool> insert(const value_type &value)
+	{
+		pair<typename tree::iterator, bool> p = _bt.insert(value);
+		return make_pair(iterator(p.first), p.second);
+	}
+	iterator insert(iterator, const value_type &value) { return _bt.insert(value).first; }
+	template <class InputIt>
+	void insert(InputIt first, InputIt last)
+	{
+		_bt.insert_range(first, last);
+	}
+	iterator erase(iterator pos) { return _bt.erase(pos); }
+	iterator erase(iterator first, iterator last) { return _bt.erase(first, last); }
+	size_type erase(const key_type &key) { return _bt.erase_key(key); }
+	void swap(btree_set &other) { _bt.swap(other._bt); }
+
+	size_type count(const Key &key) const { return find(key) != end(); }
+	iterator find(const Key &key) const { return _bt.find(key); }
+	pair<iterator, iterator> equal_range(const Key &key) const
+	{
+		return make_pair(iterator(_bt.lower_bound(key)), iterator(_bt.upper_bound(key)));
+	}
+	iterator lower_bound(const Key &key) const { return _bt.lower_bound(key); }
+	iterator upper_bound(const Key &key) const { return _bt.upper_bound(key); }
+
+	// heterogeneous lookup, for a Compare that defines is_transparent
+	template <class K>
+	typename enable_if_transparent<Compare, K, size_type>::type
+	count(const K &key) const { return find(key) != end(); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	find(const K &key) const { return _bt.find(key); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, pair<iterator, iterator> >::type
+	equal_range(const K &key) const
+	{
+		return make_pair(iterator(_bt.lower_bound(key)), iterator(_bt.upper_bound(key)));
+	}
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	lower_bound(const K &key) const { return _bt.lower_bound(key); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	upper_bound(const K &key) const { return _bt.upper_bound(key); }
+
+	key_compare key_comp() const { return _comp; }
+	value_compare value_comp() const { return _comp; }
+
+private:
+	Allocator _alloc;
+	Compare _comp;
+	tree _bt;
+};
+
+template <class Key, class Compare, class Alloc>
+bool operator==(const ft::btree_set<Key, Compare, Alloc> &lhs,
+				const ft::btree_set<Key, Compare, Alloc> &rhs)
+{
+	if (lhs.size() != rhs.size())
+		return false;
+	typename ft::btree_set<Key, Compare, Alloc>::const_iterator itl = lhs.begin();
+	typename ft::btree_set<Key, Compare, Alloc>::const_iterator itr = rhs.begin();
+	while (itl != lhs.end() && *itl == *itr)
+	{
+		++itl;
+		++itr;
+	}
+	return (itl == lhs.end());
+}
+
+template <class Key, class Compare, class Alloc>
+bool operator!=(const ft::btree_set<Key, Compare, Alloc> &lhs,
+				const ft::btree_set<Key, Compare, Alloc> &rhs) { return (!(lhs == rhs)); }
+
+template <class Key, class Compare, class Alloc>
+bool operator<(const ft::btree_set<Key, Compare, Alloc> &lhs,
+			   const ft::btree_set<Key, Compare, Alloc> &rhs)
+{
+	typename ft::btree_set<Key, Compare, Alloc>::const_iterator itl = lhs.begin();
+	typename ft::btree_set<Key, Compare, Alloc>::const_iterator itr = rhs.begin();
+	while (itl != lhs.end() && itr != rhs.end() && *itl == *itr)
+	{
+		++itl;
+		++itr;
+	}
+	return (itl == lhs.end() && itr != rhs.end()) || (itl != lhs.end() && itr != rhs.end() && *itl < *itr);
+}
+
+template <class Key, class Compare, class Alloc>
+bool operator<=(const ft::btree_set<Key, Compare, Alloc> &lhs,
+				const ft::btree_set<Key, Compare, Alloc> &rhs) { return (!(rhs < lhs)); }
+
+template <class Key, class Compare, class Alloc>
+bool operator>(const ft::btree_set<Key, Compare, Alloc> &lhs,
+			   const ft::btree_set<Key, Compare, Alloc> &rhs) { return (rhs < lhs); }
+
+template <class Key, class Compare, class Alloc>
+bool operator>=(const ft::btree_set<Key, Compare, Alloc> &lhs,
+				const ft::btree_set<Key, Compare, Alloc> &rhs) { return (!(lhs < rhs)); }
+
+template <class Key, class Compare, class Alloc>
+void swap(ft::btree_set<Key, Compare, Alloc> &lhs,
+		  ft::btree_set<Key, Compare, Alloc> &rhs) { lhs.swap(rhs); }
@@ -0,0 +1,390 @@
+#pragma once
+#include <memory>
+#include <new>
+#include <functional>
+#include "pair.hpp"
+#include "epoch.hpp"
+
+namespace ft
+{
+	template <class Key, class T, class Compare = std::less<Key>,
+			  class Allocator = std::allocator<pair<const Key, T> > >
+	class concurrent_map;
+}
+
+/*
+** Ordered map for many threads at once: a lock-free skip list (Fraser's,
+** with Harris-style marked links). count() and find() only read; they
+** skip erased nodes without helping to unlink them, so they finish in a
+** bounded number of steps. insert() and erase() retry their CASes but
+** never wait on another thread. Unlinked nodes go through an epoch domain
+** (epoch.hpp), so they are only freed once no reader can still hold them.
+**
+** Values are immutable once inserted: insert() never overwrites, and
+** iterators are const. An iterator pins the calling thread's epoch while
+** it lives, which keeps the node under it (and everything it can step to)
+** alive; iteration is ordered and sees every key present throughout,
+** while keys inserted or erased meanwhile may or may not show up.
+** Iterators belong to the thread that made them. size() is exact only
+** when no update is running. The allocator is shared by all threads.
+*/
+template <class Key, class T, class Compare, class Allocator>
+class ft::concurrent_map
+{
+public:
+	typedef Key key_type;
+	typedef T mapped_type;
+	typedef pair<const Key, T> value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef Compare key_compare;
+	typedef Allocator allocator_type;
+	typedef const value_type &const_reference;
+
+private:
+	// a quarter of the nodes at each level goes up to the next: fine up to 4^16 keys
+	enum { MAX_HEIGHT = 16 };
+	struct node
+	{
+		value_type value;	// never built in the head
+		int height;
+		int owners;			// the inserter and the eraser both let go before it's retired
+		node *next[1];		// height links, the lowest first; bit 0 marks the node erased
+	};
+	typedef typename Allocator::template rebind<node>::other node_allocator;
+
+public:
+	class const_iterator
+	{
+	public:
+		typedef std::ptrdiff_t difference_type;
+		typedef concurrent_map::value_type value_type;
+		typedef const value_type &reference;
+		typedef const value_type *pointer;
+		typedef std::forward_iterator_tag iterator_category;
+
+		const_iterator() : _m(NULL), _n(NULL) {}
+		const_iterator(const const_iterator &other) : _m(other._m), _n(other._n)
+		{
+			if (_m)
+				_m->_epoch.pin();
+		}
+		~const_iterator()
+		{
+			if (_m)
+				_m->_epoch.unpin();
+		}
+
+		const_iterator &operator=(const const_iterator &other)
+		{
+			if (other._m)
+				other._m->_epoch.pin();
+			if (_m)
+				_m->_epoch.unpin();
+			_m = other._m;
+			_n = other._n;
+			return *this;
+		}
+		bool operator==(const const_iterator &other) const { return _n == other._n; }
+		bool operator!=(const const_iterator &other) const { return _n != other._n; }
+
+		const_iterator &operator++()
+		{
+			_n = live(load(_n->next[0]));
+			return *this;
+		}
+		const_iterator operator++(int)
+		{
+			const_iterator t(*this);
+			++*this;
+			return t;
+		}
+
+		reference operator*() const { return _n->value; }
+		pointer operator->() const { return &_n->value; }
+
+	private:
+		friend class concurrent_map;
+		explicit const_iterator(const concurrent_map *m) : _m(m), _n(NULL) { _m->_epoch.pin(); }
+
+		const concurrent_map *_m;
+		node *_n;
+	};
+	typedef const_iterator iterator;
+
+	concurrent_map() : _size(0), _top(1) { _head = allocate(MAX_HEIGHT); }
+	explicit concurrent_map(const Compare &comp,
+							const Allocator &alloc = Allocator()) : _size(0),
+																	_top(1),
+																	_comp(comp),
+																	_alloc(alloc)
+	{
+		_head = allocate(MAX_HEIGHT);
+	}
+	// no other thread may be using the map
+	~concurrent_map()
+	{
+		for (node *n = unmarked(_head->next[0]); n;)
+		{
+			node *next = unmarked(n->next[0]);
+			destroy(n);
+			n = next;
+		}
+		deallocate(_head);
+	}
+	allocator_type get_allocator() const { return _alloc; }
+
+	const_iterator begin() const
+	{
+		const_iterator it(this);
+		it._n = live(load(_head->next[0]));
+		return it;
+	}
+	const_iterator end() const { return const_iterator(this); }
+
+	bool empty() const { return size() == 0; }
+	size_type size() const { return __atomic_load_n(&_size, __ATOMIC_RELAXED); }
+
+	// false, leaving the map as it was, when key is already there
+	bool insert(const value_type &value)
+	{
+		epoch::guard pin(_epoch);
+		node *preds[MAX_HEIGHT], *succs[MAX_HEIGHT], *n = NULL;
+		const Key &key = value.first;
+		int h = random_height();
+		// searches start at _top, so it goes up before n can be linked that high
+		int top = __atomic_load_n(&_top, __ATOMIC_RELAXED);
+		while (top < h && !__atomic_compare_exchange_n(&_top, &top, h, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+			;
+		for (;;)
+		{
+			if (search(key, preds, succs))
+			{
+				if (n)
+					destroy(n);
+				return false;
+			}
+			if (!n)
+				n = create(value, h);
+			for (int i = 0; i < h; i++)
+				n->next[i] = succs[i];
+			if (cas(preds[0]->next[0], succs[0], n))
+				break;
+		}
+		__atomic_add_fetch(&_size, 1, __ATOMIC_RELAXED);
+		// the upper levels are shortcuts, linked bottom up until n gets erased
+		for (int i = 1; i < h && link(n, i, preds, succs); i++)
+			;
+		if (marked(load(n->next[0])))
+			search(key, preds, succs);
+		release(n);
+		return true;
+	}
+	size_type erase(const Key &key)
+	{
+		epoch::guard pin(_epoch);
+		node *preds[MAX_HEIGHT], *succs[MAX_HEIGHT];
+		if (!search(key, preds, succs))
+			return 0;
+		node *n = succs[0];
+		for (int i = n->height - 1; i > 0; i--)
+			mark(n->next[i]);
+		// whoever marks the bottom link erased the key
+		if (!mark(n->next[0]))
+			return 0;
+		__atomic_sub_fetch(&_size, 1, __ATOMIC_RELAXED);
+		search(key, preds, succs);
+		release(n);
+		return 1;
+	}
+
+	size_type count(const Key &key) const
+	{
+		epoch::guard pin(_epoch);
+		node *n = first_not_less(key);
+		return n && !_comp(key, n->value.first);
+	}
+	const_iterator find(const Key &key) const
+	{
+		const_iterator it(this);
+		node *n = first_not_less(key);
+		if (n && !_comp(key, n->value.first))
+			it._n = n;
+		return it;
+	}
+	const_iterator lower_bound(const Key &key) const
+	{
+		const_iterator it(this);
+		it._n = first_not_less(key);
+		return it;
+	}
+
+	key_compare key_comp() const { return _comp; }
+
+private:
+	concurrent_map(const concurrent_map &);
+	concurrent_map &operator=(const concurrent_map &);
+
+	static bool marked(node *p) { return reinterpret_cast<std::size_t>(p) & 1; }
+	static node *unmarked(node *p) { return reinterpret_cast<node *>(reinterpret_cast<std::size_t>(p) & ~std::size_t(1)); }
+	static node *load(node *const &link) { return __atomic_load_n(&link, __ATOMIC_ACQUIRE); }
+	static bool cas(node *&link, node *expected, node *desired)
+	{
+		return __atomic_compare_exchange_n(&link, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+	}
+	// sets the mark on link; false if it was set already
+	static bool mark(node *&link)
+	{
+		node *p = load(link);
+		while (!marked(p))
+			if (__atomic_compare_exchange_n(&link, &p, reinterpret_cast<node *>(reinterpret_cast<std::size_t>(p) | 1),
+											false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+				return true;
+		return false;
+	}
+	// n, or the first node after it that isn't erased
+	static node *live(node *n)
+	{
+		n = unmarked(n);
+		while (n && marked(load(n->next[0])))
+			n = unmarked(load(n->next[0]));
+		return n;
+	}
+
+	/*
+	** Fills in the window around key at every level in use (below _top,
+	** which never comes down): preds[i] the last node before it, succs[i]
+	** the first at or after it, erased nodes met on the way unlinked.
+	** True if succs[0] holds key.
+	*/
+	bool search(const Key &key, node **preds, node **succs) const
+	{
+		while (!window(key, preds, succs))
+			;
+		return succs[0] && !_comp(key, succs[0]->value.first);
+	}
+	// false when an unlink failed because its pred was erased meanwhile
+	bool window(const Key &key, node **preds, node **succs) const
+	{
+		node *pred = _head;
+		for (int i = __atomic_load_n(&_top, __ATOMIC_ACQUIRE) - 1; i >= 0; i--)
+		{
+			node *curr = unmarked(load(pred->next[i]));
+			while (curr)
+			{
+				node *succ = load(curr->next[i]);
+				if (marked(succ))
+				{
+					if (!cas(pred->next[i], curr, unmarked(succ)))
+						return false;
+					curr = unmarked(succ);
+				}
+				else if (_comp(curr->value.first, key))
+				{
+					pred = curr;
+					curr = succ;
+				}
+				else
+					break;
+			}
+			preds[i] = pred;
+			succs[i] = curr;
+		}
+		return true;
+	}
+	// read-only descent: the first node not erased with a key not less than key
+	node *first_not_less(const Key &key) const
+	{
+		node *pred = _head, *curr = NULL;
+		for (int i = __atomic_load_n(&_top, __ATOMIC_ACQUIRE) - 1; i >= 0; i--)
+			for (curr = unmarked(load(pred->next[i])); curr;)
+			{
+				node *succ = load(curr->next[i]);
+				if (marked(succ))
+					curr = unmarked(succ);
+				else if (_comp(curr->value.first, key))
+				{
+					pred = curr;
+					curr = succ;
+				}
+				else
+					break;
+			}
+		return curr;
+	}
+	// links n in at level i; false once n is erased, which ends its linking
+	bool link(node *n, int i, node **preds, node **succs)
+	{
+		for (;;)
+		{
+			node *next = load(n->next[i]);
+			if (marked(next))
+				return false;
+			if (next != succs[i] && !cas(n->next[i], next, succs[i]))
+				continue;
+			if (cas(preds[i]->next[i], succs[i], n))
+				return true;
+			search(n->value.first, preds, succs);
+			if (succs[0] != n)
+				return false;
+		}
+	}
+	int random_height() const
+	{
+		static __thread unsigned long seed;
+		if (!seed)
+			seed = reinterpret_cast<std::size_t>(&seed) | 1;
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		int h = 1;
+		for (unsigned long r = seed; h < MAX_HEIGHT && !(r & 3); r >>= 2)
+			++h;
+		return h;
+	}
+
+	node *allocate(int height)
+	{
+		size_type units = 1 + ((height - 1) * sizeof(node *) + sizeof(node) - 1) / sizeof(node);
+		node *n = _alloc.allocate(units);
+		n->height = height;
+		for (int i = 0; i < height; i++)
+			n->next[i] = NULL;
+		return n;
+	}
+	void deallocate(node *n)
+	{
+		_alloc.deallocate(n, 1 + ((n->height - 1) * sizeof(node *) + sizeof(node) - 1) / sizeof(node));
+	}
+	node *create(const value_type &value, int height)
+	{
+		node *n = allocate(height);
+		try { new (&n->value) value_type(value); }
+		catch (...) { deallocate(n); throw; }
+		n->owners = 2;
+		return n;
+	}
+	void destroy(node *n)
+	{
+		n->value.~value_type();
+		deallocate(n);
+	}
+	// retires n once both its inserter and its eraser are done with it
+	void release(node *n)
+	{
+		if (!__atomic_sub_fetch(&n->owners, 1, __ATOMIC_ACQ_REL))
+			_epoch.retire(n, reclaim, this);
+	}
+	static void reclaim(void *map, void *n)
+	{
+		static_cast<concurrent_map *>(map)->destroy(static_cast<node *>(n));
+	}
+
+	node *_head;
+	size_type _size;
+	int _top;
+	Compare _comp;
+	node_allocator _alloc;
+	// last, so that it reclaims what's left while _alloc is still there
+	epoch _epoch;
+};
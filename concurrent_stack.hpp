@@ -0,0 +1,163 @@
+#pragma once
+#include <memory>
+#include <new>
+#include "epoch.hpp"
+
+namespace ft
+{
+	template <class T, class Allocator = std::allocator<T> >
+	class concurrent_stack;
+}
+
+/*
+** LIFO for many threads at once: a Treiber stack, i.e. a linked list
+** whose head is swung by CAS. Popped nodes are retired to an epoch domain
+** rather than freed, which rules out ABA as well: a node can't be freed
+** and come back at the same address while a thread that read it is
+** still pinned, and values are always pushed in new nodes. The batched
+** calls link or unlink a whole chain with a single CAS. Nodes are freed
+** on whichever thread reclaims them, so the allocator must be safe to
+** share (std::allocator).
+*/
+template <class T, class Allocator>
+class ft::concurrent_stack
+{
+public:
+	typedef T value_type;
+	typedef std::size_t size_type;
+	typedef Allocator allocator_type;
+
+	concurrent_stack() : _head(NULL) {}
+	explicit concurrent_stack(const Allocator &alloc) : _head(NULL), _alloc(alloc) {}
+	// no other thread may be using the stack
+	~concurrent_stack()
+	{
+		while (_head)
+		{
+			node *n = _head;
+			_head = n->next;
+			destroy(n);
+		}
+	}
+	allocator_type get_allocator() const { return _alloc; }
+
+	bool empty() const { return !__atomic_load_n(&_head, __ATOMIC_ACQUIRE); }
+	void push(const T &value)
+	{
+		node *n = create(value, NULL);
+		link(n, n);
+	}
+	// pushes them one after the other (*--last ends up on top) in one go
+	template <class InputIt>
+	void push(InputIt first, InputIt last)
+	{
+		if (first == last)
+			return;
+		node *top = create(*first, NULL), *bottom = top;
+		try
+		{
+			while (++first != last)
+				top = create(*first, top);
+		}
+		catch (...)
+		{
+			unwind(top);
+			throw;
+		}
+		link(top, bottom);
+	}
+	// false if there was nothing to pop
+	bool pop(T &out)
+	{
+		return pop(&out, 1);
+	}
+	// pops up to n values in one go, the top first; returns how many
+	template <class OutputIt>
+	size_type pop(OutputIt out, size_type n)
+	{
+		if (!n)
+			return 0;
+		epoch::guard pin(_epoch);
+		node *top = __atomic_load_n(&_head, __ATOMIC_ACQUIRE), *bottom;
+		size_type k;
+		do
+		{
+			if (!top)
+				return 0;
+			bottom = top;
+			for (k = 1; k < n; k++)
+			{
+				node *next = __atomic_load_n(&bottom->next, __ATOMIC_ACQUIRE);
+				if (!next)
+					break;
+				bottom = next;
+			}
+		} while (!__atomic_compare_exchange_n(&_head, &top, __atomic_load_n(&bottom->next, __ATOMIC_ACQUIRE),
+											  true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+		// the chain is ours now; cut it so that it can be reclaimed as one
+		__atomic_store_n(&bottom->next, static_cast<node *>(NULL), __ATOMIC_RELAXED);
+		try
+		{
+			for (node *c = top; c; c = c->next)
+				*out++ = c->value;
+		}
+		catch (...)
+		{
+			_epoch.retire(top, reclaim, this);
+			throw;
+		}
+		_epoch.retire(top, reclaim, this);
+		return k;
+	}
+
+private:
+	struct node
+	{
+		node(const T &v, node *n) : value(v), next(n) {}
+		T value;
+		node *next;
+	};
+	typedef typename Allocator::template rebind<node>::other node_allocator;
+
+	concurrent_stack(const concurrent_stack &);
+	concurrent_stack &operator=(const concurrent_stack &);
+
+	// puts the chain top ... bottom on the stack
+	void link(node *top, node *bottom)
+	{
+		node *head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+		do
+			bottom->next = head;
+		while (!__atomic_compare_exchange_n(&_head, &head, top, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+	}
+	node *create(const T &value, node *next)
+	{
+		node *n = _alloc.allocate(1);
+		try { new (n) node(value, next); }
+		catch (...) { _alloc.deallocate(n, 1); throw; }
+		return n;
+	}
+	void destroy(node *n)
+	{
+		n->~node();
+		_alloc.deallocate(n, 1);
+	}
+	void unwind(node *n)
+	{
+		while (n)
+		{
+			node *next = n->next;
+			destroy(n);
+			n = next;
+		}
+	}
+	static void reclaim(void *stack, void *chain)
+	{
+		static_cast<concurrent_stack *>(stack)->unwind(static_cast<node *>(chain));
+	}
+
+	node *_head;
+	node_allocator _alloc;
+	// last, so that it reclaims what's left while _alloc is still there
+	epoch _epoch;
+};
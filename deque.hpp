@@ -0,0 +1,374 @@
+#pragma once
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include "traits.hpp"
+#include "reverse_iterator.hpp"
+
+namespace ft
+{
+	template <class T, class A = std::allocator<T> >
+	class deque;
+}
+
+/*
+** Double-ended queue over fixed-size blocks: push and pop at either end
+** are O(1) and never move an element, so references and pointers stay
+** valid until their element is popped. A map of block pointers, with
+** room left at both ends, finds element i in O(1); only the map is ever
+** copied, when it runs out of room. Like std::deque, a push invalidates
+** iterators (which go through the map) but not references.
+**
+** A block that empties is kept as a spare while the one beyond it is
+** freed, so a stack pushing and popping across a block boundary doesn't
+** allocate every time.
+*/
+template <class T, class A>
+class ft::deque
+{
+public:
+	typedef typename A::value_type value_type;
+	typedef typename A::reference reference;
+	typedef typename A::const_reference const_reference;
+	typedef typename A::pointer pointer;
+	typedef typename A::const_pointer const_pointer;
+	typedef typename A::difference_type difference_type;
+	typedef typename A::size_type size_type;
+	typedef A allocator_type;
+
+private:
+	// about 4 KB per block, but never fewer than 16 elements
+	enum { BLOCK = sizeof(T) <= 4096 / 16 ? 4096 / sizeof(T) : 16 };
+	typedef typename A::template rebind<T *>::other map_allocator;
+
+public:
+	class const_iterator
+	{
+	public:
+		typedef typename A::difference_type difference_type;
+		typedef typename A::value_type value_type;
+		typedef typename A::const_reference reference;
+		typedef typename A::const_pointer pointer;
+		typedef std::random_access_iterator_tag iterator_category;
+
+		const_iterator() : _map(NULL), _pos(0) {}
+		const_iterator(T *const *map, size_type pos) : _map(map), _pos(pos) {}
+
+		bool operator==(const const_iterator &other) const { return _pos == other._pos; }
+		bool operator!=(const const_iterator &other) const { return _pos != other._pos; }
+		bool operator<(const const_iterator &other) const { return _pos < other._pos; }
+		bool operator>(const const_iterator &other) const { return _pos > other._pos; }
+		bool operator<=(const const_iterator &other) const { return _pos <= other._pos; }
+		bool operator>=(const const_iterator &other) const { return _pos >= other._pos; }
+
+		const_iterator &operator++() { ++_pos; return (*this); }
+		const_iterator operator++(int) { const_iterator t(*this); ++_pos; return t; }
+		const_iterator &operator--() { --_pos; return (*this); }
+		const_iterator operator--(int) { const_iterator t(*this); --_pos; return t; }
+		const_iterator &operator+=(difference_type n) { _pos += n; return *this; }
+		const_iterator operator+(difference_type n) const { return const_iterator(_map, _pos + n); }
+		friend const_iterator operator+(difference_type n, const const_iterator &other) { return other + n; }
+		const_iterator &operator-=(difference_type n) { _pos -= n; return *this; }
+		const_iterator operator-(difference_type n) const { return const_iterator(_map, _pos - n); }
+		difference_type operator-(const const_iterator &other) const { return difference_type(_pos - other._pos); }
+
+		reference operator*() const { return _map[_pos / BLOCK][_pos % BLOCK]; }
+		pointer operator->() const { return &**this; }
+		reference operator[](difference_type n) const { return *(*this + n); }
+
+	protected:
+		T *const *_map;
+		size_type _pos;	// in map space: block _pos / BLOCK, slot _pos % BLOCK
+	};
+
+	class iterator : public const_iterator
+	{
+	private:
+		typedef const_iterator cit;
+
+	public:
+		typedef typename A::difference_type difference_type;
+		typedef typename A::value_type value_type;
+		typedef typename A::reference reference;
+		typedef typename A::pointer pointer;
+		typedef std::random_access_iterator_tag iterator_category;
+
+		iterator() {}
+		iterator(T *const *map, size_type pos) : cit(map, pos) {}
+
+		iterator &operator++() { cit::operator++(); return (*this); }
+		iterator operator++(int) { iterator t(*this); cit::operator++(); return t; }
+		iterator &operator--() { cit::operator--(); return (*this); }
+		iterator operator--(int) { iterator t(*this); cit::operator--(); return t; }
+		iterator &operator+=(difference_type n) { cit::operator+=(n); return *this; }
+		iterator operator+(difference_type n) const { return iterator(cit::_map, cit::_pos + n); }
+		friend iterator operator+(difference_type n, const iterator &other) { return other + n; }
+		iterator &operator-=(difference_type n) { cit::operator-=(n); return *this; }
+		iterator operator-(difference_type n) const { return iterator(cit::_map, cit::_pos - n); }
+		difference_type operator-(const const_iterator &other) const { return cit::operator-(other); }
+
+		reference operator*() const { return cit::_map[cit::_pos / BLOCK][cit::_pos % BLOCK]; }
+		pointer operator->() const { return &**this; }
+		reference operator[](difference_type n) const { return *(*this + n); }
+	};
+
+	iterator begin() { return iterator(_map, _begin); }
+	const_iterator begin() const { return const_iterator(_map, _begin); }
+	iterator end() { return iterator(_map, _end); }
+	const_iterator end() const { return const_iterator(_map, _end); }
+
+	typedef typename ft::reverse_iterator<iterator> reverse_iterator;
+	typedef typename ft::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	reverse_iterator rbegin() { return reverse_iterator(end()); }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+	reverse_iterator rend() { return reverse_iterator(begin()); }
+	const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+	deque() : _map(NULL), _map_size(0), _begin(0), _end(0) {}
+	explicit deque(const A &alloc) : _alloc(alloc), _map_alloc(alloc), _map(NULL), _map_size(0), _begin(0), _end(0) {}
+	explicit deque(size_type count, const T &value = T(),
+				   const A &alloc = A()) : _alloc(alloc),
+										   _map_alloc(alloc),
+										   _map(NULL),
+										   _map_size(0),
+										   _begin(0),
+										   _end(0)
+	{
+		try { resize(count, value); }
+		catch (...) { release(); throw; }
+	}
+	template <class InputIt>
+	deque(InputIt first, InputIt last,
+		  const A &alloc = A()) : _alloc(alloc),
+								  _map_alloc(alloc),
+								  _map(NULL),
+								  _map_size(0),
+								  _begin(0),
+								  _end(0)
+	{
+		try { assign(first, last); }
+		catch (...) { release(); throw; }
+	}
+	deque(const deque &other) : _alloc(allocator_copy<A>::select(other._alloc)),
+								_map_alloc(allocator_copy<map_allocator>::select(other._map_alloc)),
+								_map(NULL),
+								_map_size(0),
+								_begin(0),
+								_end(0)
+	{
+		try { assign(other.begin(), other.end()); }
+		catch (...) { release(); throw; }
+	}
+	~deque() { release(); }
+	deque &operator=(const deque &other)
+	{
+		if (this != &other)
+			assign(other.begin(), other.end());
+		return *this;
+	}
+	allocator_type get_allocator() const { return _alloc; }
+
+	void assign(size_type count, const T &value)
+	{
+		T v(value);
+		clear();
+		resize(count, v);
+	}
+	template <class InputIt>
+	void assign(InputIt first,
+				typename enable_if<!is_integral<InputIt>::value, InputIt>::type last)
+	{
+		clear();
+		for (; first != last; ++first)
+			push_back(*first);
+	}
+
+	reference at(size_type n)
+	{
+		if (n >= size())
+			throw std::out_of_range("deque::at");
+		return (*this)[n];
+	}
+	const_reference at(size_type n) const
+	{
+		if (n >= size())
+			throw std::out_of_range("deque::at");
+		return (*this)[n];
+	}
+	reference operator[](size_type n) { return *slot(_begin + n); }
+	const_reference operator[](size_type n) const { return *slot(_begin + n); }
+	reference front() { return *slot(_begin); }
+	const_reference front() const { return *slot(_begin); }
+	reference back() { return *slot(_end - 1); }
+	const_reference back() const { return *slot(_end - 1); }
+
+	bool empty() const { return _begin == _end; }
+	size_type size() const { return _end - _begin; }
+	size_type max_size() const { return _alloc.max_size(); }
+
+	void push_back(const T &value)
+	{
+		if (_end == _map_size * BLOCK)
+			remap();
+		T *&block = _map[_end / BLOCK];
+		if (!block)
+			block = _alloc.allocate(BLOCK);
+		new (block + _end % BLOCK) T(value);
+		++_end;
+	}
+	void push_front(const T &value)
+	{
+		if (_begin == 0)
+			remap();
+		T *&block = _map[(_begin - 1) / BLOCK];
+		if (!block)
+			block = _alloc.allocate(BLOCK);
+		new (block + (_begin - 1) % BLOCK) T(value);
+		--_begin;
+	}
+	void pop_back()
+	{
+		--_end;
+		slot(_end)->~T();
+		// block _end / BLOCK is empty now: it stays as the spare, the old spare goes
+		if (_end % BLOCK == 0 && _end / BLOCK + 1 < _map_size)
+			free_blocks(_end / BLOCK + 1, _end / BLOCK + 2);
+	}
+	void pop_front()
+	{
+		slot(_begin)->~T();
+		++_begin;
+		if (_begin % BLOCK == 0 && _begin / BLOCK >= 2)
+			free_blocks(_begin / BLOCK - 2, _begin / BLOCK - 1);
+	}
+	void resize(size_type count, const T &value = T())
+	{
+		while (size() > count)
+			pop_back();
+		while (size() < count)
+			push_back(value);
+	}
+	// the blocks go too, the map stays
+	void clear()
+	{
+		for (size_type p = _begin; p != _end; p++)
+			slot(p)->~T();
+		free_blocks(0, _map_size);
+		_begin = _end = _map_size / 2 * BLOCK;
+	}
+	void swap(deque &other)
+	{
+		std::swap(_alloc, other._alloc);
+		std::swap(_map_alloc, other._map_alloc);
+		std::swap(_map, other._map);
+		std::swap(_map_size, other._map_size);
+		std::swap(_begin, other._begin);
+		std::swap(_end, other._end);
+	}
+
+private:
+	A _alloc;
+	map_allocator _map_alloc;
+	T **_map;
+	size_type _map_size;
+	size_type _begin;	// the elements are [_begin, _end) in map space
+	size_type _end;
+
+	T *slot(size_type pos) const { return _map[pos / BLOCK] + pos % BLOCK; }
+	// everything, the map too: for the destructor, and for constructors that throw, as it won't run then
+	void release()
+	{
+		clear();
+		if (_map)
+			_map_alloc.deallocate(_map, _map_size);
+		_map = NULL;
+		_map_size = 0;
+	}
+	void free_blocks(size_type from, size_type to)
+	{
+		for (; from < to; from++)
+			if (_map[from])
+			{
+				_alloc.deallocate(_map[from], BLOCK);
+				_map[from] = NULL;
+			}
+	}
+	/*
+	** Moves the blocks in use, spares included, to the middle of a new map,
+	** twice as big unless they take up less than half of this one, so that
+	** there is room at both ends again. Blocks are never copied, only their
+	** pointers.
+	*/
+	void remap()
+	{
+		size_type lo = _begin / BLOCK, hi = (_end + BLOCK - 1) / BLOCK;
+		if (lo > 0 && _map[lo - 1])
+			lo--;
+		if (hi < _map_size && _map[hi])
+			hi++;
+		size_type size = _map_size;
+		if ((hi - lo + 1) * 2 > size)
+			size = std::max(size_type(8), std::max(_map_size * 2, (hi - lo + 1) * 2));
+		T **map = _map_alloc.allocate(size);
+		for (size_type i = 0; i < size; i++)
+			map[i] = NULL;
+		size_type offset = (size - (hi - lo)) / 2;
+		for (size_type i = lo; i < hi; i++)
+		{
+			map[offset + i - lo] = _map[i];
+			_map[i] = NULL;
+		}
+		if (_map)
+		{
+			free_blocks(0, _map_size);
+			_map_alloc.deallocate(_map, _map_size);
+		}
+		_map = map;
+		_map_size = size;
+		_begin = _begin + offset * BLOCK - lo * BLOCK;
+		_end = _end + offset * BLOCK - lo * BLOCK;
+	}
+};
+
+template <typename T, typename A>
+bool operator==(const ft::deque<T, A> &lhs, const ft::deque<T, A> &rhs)
+{
+	if (lhs.size() != rhs.size())
+		return false;
+	typename ft::deque<T, A>::size_type i = 0;
+	while (i < lhs.size() && lhs[i] == rhs[i])
+		i++;
+	return i == lhs.size();
+}
+
+template <typename T, typename A>
+bool operator!=(const ft::deque<T, A> &lhs,
+				const ft::deque<T, A> &rhs) { return !(lhs == rhs); }
+
+template <typename T, typename A>
+bool operator<(const ft::deque<T, A> &lhs, const ft::deque<T, A> &rhs)
+{
+	typename ft::deque<T, A>::size_type i = 0, lsz = lhs.size(), rsz = rhs.size();
+	while (i < lsz && i < rsz && lhs[i] == rhs[i])
+		i++;
+	return (i == lsz && i < rsz) || (i < lsz && i < rsz && lhs[i] < rhs[i]);
+}
+
+template <typename T, typename A>
+bool operator>=(const ft::deque<T, A> &lhs,
+				const ft::deque<T, A> &rhs) { return !(lhs < rhs); }
+
+template <typename T, typename A>
+bool operator>(const ft::deque<T, A> &lhs,
+			   const ft::deque<T, A> &rhs) { return (rhs < lhs); }
+
+template <typename T, typename A>
+bool operator<=(const ft::deque<T, A> &lhs,
+				const ft::deque<T, A> &rhs) { return !(rhs < lhs); }
+
+template <typename T, typename A>
+void swap(ft::deque<T, A> &lhs,
+		  ft::deque<T, A> &rhs) { lhs.swap(rhs); }
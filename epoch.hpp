@@ -0,0 +1,190 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <pthread.h>
+#include "vector.hpp"
+
+namespace ft
+{
+	class epoch;
+}
+
+/*
+** Epoch-based reclamation for the lock-free containers. Every access to
+** shared nodes happens with the domain pinned (an epoch::guard in scope);
+** a node unlinked from its structure is retire()d rather than freed, and
+** reclaimed once no thread can still be looking at it. The global epoch
+** only advances when every pinned thread has seen the current one, so a
+** node retired in epoch e is safe to free from epoch e + 2 on.
+**
+** Each thread gets a record the first time it pins a domain; the record
+** goes back to the domain when the thread exits, for the next thread to
+** take over with whatever it still had retired. Atomics are the GCC
+** __atomic builtins, so this stays usable from C++98.
+*/
+class ft::epoch
+{
+public:
+	typedef void (*reclaim_fn)(void *ctx, void *p);
+
+	epoch() : _global(0), _records(NULL), _id(__atomic_add_fetch(&next_id(), 1, __ATOMIC_RELAXED))
+	{
+		if (pthread_key_create(&_key, release))
+			throw std::bad_alloc();
+	}
+	// no thread may still be using the domain
+	~epoch()
+	{
+		pthread_key_delete(_key);
+		while (_records)
+		{
+			record *r = _records;
+			_records = r->next;
+			for (int b = 0; b < 3; b++)
+				reclaim(r->limbo[b]);
+			delete r;
+		}
+	}
+
+	// pins the calling thread's record for as long as it lives; guards nest
+	class guard
+	{
+	public:
+		explicit guard(const epoch &e) : _epoch(e) { _epoch.pin(); }
+		~guard() { _epoch.unpin(); }
+
+	private:
+		guard(const guard &);
+		guard &operator=(const guard &);
+		const epoch &_epoch;
+	};
+
+	void pin() const
+	{
+		record *r = local();
+		if (r->nesting++)
+			return;
+		unsigned long e = __atomic_load_n(&_global, __ATOMIC_ACQUIRE);
+		__atomic_store_n(&r->state, e << 1 | 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		// the bucket two epochs back is nobody's business any more
+		if (r->seen != e)
+		{
+			reclaim(r->limbo[(e + 1) % 3]);
+			r->seen = e;
+		}
+	}
+	void unpin() const
+	{
+		record *r = local();
+		if (!--r->nesting)
+			__atomic_store_n(&r->state, 0UL, __ATOMIC_RELEASE);
+	}
+	/*
+	** Hands p, already unlinked, to fn(ctx, p) once it's safe. The tag is
+	** the global epoch now, not the caller's: the caller may have pinned
+	** an epoch ago, and threads that pinned since can still hold p.
+	*/
+	void retire(void *p, reclaim_fn fn, void *ctx) const
+	{
+		record *r = local();
+		unsigned long e = __atomic_load_n(&_global, __ATOMIC_SEQ_CST);
+		ft::vector<retired> &bucket = r->limbo[e % 3];
+		retired x = {p, fn, ctx};
+		bucket.push_back(x);
+		if (bucket.size() % ADVANCE_EVERY == 0)
+			advance();
+	}
+
+private:
+	enum { ADVANCE_EVERY = 64 };
+	struct retired
+	{
+		void *p;
+		reclaim_fn fn;
+		void *ctx;
+	};
+	struct record
+	{
+		record() : state(0), nesting(0), seen(0), in_use(1), next(NULL) {}
+		unsigned long state;	// epoch << 1 | pinned
+		unsigned nesting;
+		unsigned long seen;
+		int in_use;
+		record *next;
+		ft::vector<retired> limbo[3];
+	};
+
+	epoch(const epoch &);
+	epoch &operator=(const epoch &);
+
+	static void reclaim(ft::vector<retired> &bucket)
+	{
+		for (std::size_t i = 0; i < bucket.size(); i++)
+			bucket[i].fn(bucket[i].ctx, bucket[i].p);
+		bucket.clear();
+	}
+	// moves the epoch on if every pinned thread has caught up with it
+	void advance() const
+	{
+		unsigned long e = __atomic_load_n(&_global, __ATOMIC_SEQ_CST);
+		for (record *r = __atomic_load_n(&_records, __ATOMIC_ACQUIRE); r; r = r->next)
+		{
+			unsigned long s = __atomic_load_n(&r->state, __ATOMIC_SEQ_CST);
+			if ((s & 1) && s >> 1 != e)
+				return;
+		}
+		__atomic_compare_exchange_n(&_global, &e, e + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+	}
+	static unsigned long &next_id()
+	{
+		static unsigned long id;
+		return id;
+	}
+	/*
+	** The calling thread's record: its own, one left by an exited thread,
+	** or a new one. The last domain the thread used is remembered by id,
+	** which unlike the address is never reused.
+	*/
+	record *local() const
+	{
+		static __thread unsigned long last_id;
+		static __thread record *last;
+		if (last_id == _id)
+			return last;
+		record *r = static_cast<record *>(pthread_getspecific(_key));
+		if (!r)
+			r = adopt();
+		last_id = _id;
+		last = r;
+		return r;
+	}
+	record *adopt() const
+	{
+		record *r;
+		for (r = __atomic_load_n(&_records, __ATOMIC_ACQUIRE); r; r = r->next)
+		{
+			int idle = 0;
+			if (__atomic_compare_exchange_n(&r->in_use, &idle, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+				break;
+		}
+		if (!r)
+		{
+			r = new record;
+			r->next = __atomic_load_n(&_records, __ATOMIC_RELAXED);
+			while (!__atomic_compare_exchange_n(&_records, &r->next, r, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+				;
+		}
+		pthread_setspecific(_key, r);
+		return r;
+	}
+	static void release(void *p)
+	{
+		__atomic_store_n(&static_cast<record *>(p)->in_use, 0, __ATOMIC_RELEASE);
+	}
+
+	mutable unsigned long _global;
+	mutable record *_records;
+	unsigned long _id;
+	pthread_key_t _key;
+};
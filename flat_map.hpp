@@ -0,0 +1,567 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include "vector.hpp"
+#include "pair.hpp"
+#include "traits.hpp"
+#include "reverse_iterator.hpp"
+
+namespace ft
+{
+	template <class T1, class T2>
+	struct pair_ref;
+	template <class R>
+	struct arrow_proxy;
+	template <class Key, class T, class Compare = std::less<Key>,
+			  class KeyContainer = ft::vector<Key>, class MappedContainer = ft::vector<T> >
+	class flat_map;
+}
+
+// a pair of references into separate arrays, what flat_map iterators yield
+template <class T1, class T2>
+struct ft::pair_ref
+{
+	T1 &first;
+	T2 &second;
+	pair_ref(T1 &x, T2 &y) : first(x), second(y) {}
+	pair_ref(const pair_ref &p) : first(p.first), second(p.second) {}
+	template <class U1, class U2>
+	pair_ref(const pair_ref<U1, U2> &p) : first(p.first), second(p.second) {}
+	template <class U1, class U2>
+	operator pair<U1, U2>() const { return pair<U1, U2>(first, second); }
+
+private:
+	pair_ref &operator=(const pair_ref &);
+};
+
+template <class T1, class T2, class U1, class U2>
+bool operator==(const ft::pair_ref<T1, T2> &lhs, const ft::pair_ref<U1, U2> &rhs)
+{
+	return (lhs.first == rhs.first && lhs.second == rhs.second);
+}
+
+template <class T1, class T2, class U1, class U2>
+bool operator<(const ft::pair_ref<T1, T2> &lhs, const ft::pair_ref<U1, U2> &rhs)
+{
+	return (lhs.first < rhs.first || (!(rhs.first < lhs.first) && lhs.second < rhs.second));
+}
+
+// what operator-> returns for iterators whose reference is a proxy object
+template <class R>
+struct ft::arrow_proxy
+{
+	R ref;
+	arrow_proxy(const R &r) : ref(r) {}
+	const R *operator->() const { return &ref; }
+};
+
+/*
+** A map over two sorted arrays, keys and mapped values side by side at the
+** same index. Lookups are binary searches over the keys alone, which are
+** contiguous, so they touch few cache lines and cost no per-entry node.
+** Inserting or erasing one entry shifts everything after it: fill it in
+** bulk (range insert sorts the batch and merges it in) and read it often.
+** Dereferencing an iterator gives pair_ref<const Key, T> rather than a
+** reference to a stored pair; it->first and it->second work as for map.
+** Any insert or erase invalidates iterators.
+*/
+template <class Key, class T, class Compare, class KeyContainer, class MappedContainer>
+class ft::flat_map
+{
+public:
+	typedef Key key_type;
+	typedef T mapped_type;
+	typedef pair<const Key, T> value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef Compare key_compare;
+	typedef pair_ref<const Key, T> reference;
+	typedef pair_ref<const Key, const T> const_reference;
+	typedef KeyContainer key_container_type;
+	typedef MappedContainer mapped_container_type;
+
+	class value_compare
+	{
+	public:
+		typedef bool result_type;
+		typedef value_type first_argument_type;
+		typedef value_type second_argument_type;
+
+		value_compare() {}
+		template <class P1, class P2>
+		bool operator()(const P1 &lhs, const P2 &rhs) const
+		{
+			return comp(lhs.first, rhs.first);
+		}
+
+	protected:
+		friend class flat_map;
+		value_compare(Compare c) : comp(c) {}
+		Compare comp;
+	};
+
+	class const_iterator
+	{
+	public:
+		typedef std::ptrdiff_t difference_type;
+		typedef pair<const Key, T> value_type;
+		typedef pair_ref<const Key, const T> reference;
+		typedef arrow_proxy<reference> pointer;
+		typedef std::random_access_iterator_tag iterator_category;
+
+		const_iterator() : _key(NULL), _value(NULL) {}
+		const_iterator(const Key *key, const T *value) : _key(key),
+														 _value(const_cast<T *>(value)) {}
+		const_iterator(const const_iterator &other) : _key(other._key),
+													  _value(other._value) {}
+		~const_iterator() {}
+
+		const_iterator &operator=(const const_iterator &other)
+		{
+			_key = other._key;
+			_value = other._value;
+			return *this;
+		}
+		bool operator==(const const_iterator &other) const { return _key == other._key; }
+		bool operator!=(const const_iterator &other) const { return _key != other._key; }
+		bool operator<(const const_iterator &other) const { return _key < other._key; }
+		bool operator>(const const_iterator &other) const { return _key > other._key; }
+		bool operator<=(const const_iterator &other) const { return _key <= other._key; }
+		bool operator>=(const const_iterator &other) const { return _key >= other._key; }
+
+		const_iterator &operator++() { ++_key; ++_value; return *this; }
+		const_iterator operator++(int) { const_iterator t(*this); ++*this; return t; }
+		const_iterator &operator--() { --_key; --_value; return *this; }
+		const_iterator operator--(int) { const_iterator t(*this); --*this; return t; }
+		const_iterator &operator+=(difference_type n) { _key += n; _value += n; return *this; }
+		const_iterator &operator-=(difference_type n) { _key -= n; _value -= n; return *this; }
+		const_iterator operator+(difference_type n) const { return const_iterator(_key + n, _value + n); }
+		friend const_iterator operator+(difference_type n, const const_iterator &it) { return it + n; }
+		const_iterator operator-(difference_type n) const { return const_iterator(_key - n, _value - n); }
+		difference_type operator-(const const_iterator &other) const { return _key - other._key; }
+
+		reference operator*() const { return reference(*_key, *_value); }
+		pointer operator->() const { return pointer(**this); }
+		reference operator[](difference_type n) const { return *(*this + n); }
+
+	protected:
+		const Key *_key;
+		T *_value;
+	};
+
+	class iterator : public const_iterator
+	{
+	private:
+		typedef const_iterator cit;
+
+	public:
+		typedef std::ptrdiff_t difference_type;
+		typedef pair<const Key, T> value_type;
+		typedef pair_ref<const Key, T> reference;
+		typedef arrow_proxy<reference> pointer;
+		typedef std::random_access_iterator_tag iterator_category;
+
+		iterator() : cit() {}
+		iterator(const Key *key, T *value) : cit(key, value) {}
+		iterator(const iterator &other) : cit(other) {}
+		~iterator() {}
+
+		iterator &operator=(const iterator &other) { cit::operator=(other); return *this; }
+		iterator &operator++() { cit::operator++(); return *this; }
+		iterator operator++(int) { iterator t(*this); cit::operator++(); return t; }
+		iterator &operator--() { cit::operator--(); return *this; }
+		iterator operator--(int) { iterator t(*this); cit::operator--(); return t; }
+		iterator &operator+=(difference_type n) { cit::operator+=(n); return *this; }
+		iterator &operator-=(difference_type n) { cit::operator-=(n); return *this; }
+		iterator operator+(difference_type n) const { return iterator(cit::_key + n, cit::_value + n); }
+		friend iterator operator+(difference_type n, const iterator &it) { return it + n; }
+		iterator operator-(difference_type n) const { return iterator(cit::_key - n, cit::_value - n); }
+		difference_type operator-(const cit &other) const { return cit::operator-(other); }
+
+		reference operator*() const { return reference(*cit::_key, *cit::_value); }
+		pointer operator->() const { return pointer(**this); }
+		reference operator[](difference_type n) const { return *(*this + n); }
+	};
+
+	typedef ft::reverse_iterator<iterator> reverse_iterator;
+	typedef ft::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	iterator begin() { return entry(0); }
+	const_iterator begin() const { return entry(0); }
+	iterator end() { return entry(size()); }
+	const_iterator end() const { return entry(size()); }
+	reverse_iterator rbegin() { return reverse_iterator(end()); }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+	reverse_iterator rend() { return reverse_iterator(begin()); }
+	const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+	flat_map() {}
+	explicit flat_map(const Compare &comp) : _comp(comp) {}
+	template <class InputIt>
+	flat_map(InputIt first, InputIt last,
+			 const Compare &comp = Compare()) : _comp(comp) { insert(first, last); }
+	flat_map(const flat_map &other) : _comp(other._comp),
+									  _keys(other._keys),
+									  _values(other._values) {}
+	~flat_map() {}
+	flat_map &operator=(const flat_map &other)
+	{
+		if (this == &other)
+			return *this;
+		_comp = other._comp;
+		_keys = other._keys;
+		_values = other._values;
+		return *this;
+	}
+
+	T &at(const Key &key)
+	{
+		size_type i = find_index(key);
+		if (i != size())
+			return _values[i];
+		throw std::out_of_range("no element with key");
+	}
+	const T &at(const Key &key) const
+	{
+		size_type i = find_index(key);
+		if (i != size())
+			return _values[i];
+		throw std::out_of_range("no element with key");
+	}
+	T &operator[](const Key &key) { return try_emplace(key).first->second; }
+	// the mapped value is only built (from arg, if given) for a new key
+	pair<iterator, bool> try_emplace(const Key &key)
+	{
+		size_type i = lower_index(key);
+		if (i != size() && !_comp(key, _keys[i]))
+			return make_pair(entry(i), false);
+		insert_at(i, key, T());
+		return make_pair(entry(i), true);
+	}
+	template <class A1>
+	pair<iterator, bool> try_emplace(const Key &key, const A1 &arg)
+	{
+		size_type i = lower_index(key);
+		if (i != size() && !_comp(key, _keys[i]))
+			return make_pair(entry(i), false);
+		insert_at(i, key, T(arg));
+		return make_pair(entry(i), true);
+	}
+	template <class M>
+	pair<iterator, bool> insert_or_assign(const Key &key, const M &obj)
+	{
+		size_type i = lower_index(key);
+		if (i != size() && !_comp(key, _keys[i]))
+		{
+			_values[i] = obj;
+			return make_pair(entry(i), false);
+		}
+		insert_at(i, key, T(obj));
+		return make_pair(entry(i), true);
+	}
+
+	bool empty() const { return _keys.empty(); }
+	size_type size() const { return _keys.size(); }
+	size_type max_size() const { return std::min<size_type>(_keys.max_size(), _values.max_size()); }
+	void reserve(size_type n)
+	{
+		_keys.reserve(n);
+		_values.reserve(n);
+	}
+	void shrink_to_fit()
+	{
+		_keys.shrink_to_fit();
+		_values.shrink_to_fit();
+	}
+	void clear()
+	{
+		_keys.clear();
+		_values.clear();
+	}
+	pair<iterator, bool> insert(const value_type &value) { return try_emplace(value.first, value.second); }
+	// the hint is used when the value belongs right before it
+	iterator insert(iterator hint, const value_type &value)
+	{
+		size_type i = hint - begin();
+		if ((i == size() || _comp(value.first, _keys[i])) && (i == 0 || _comp(_keys[i - 1], value.first)))
+		{
+			insert_at(i, value.first, value.second);
+			return entry(i);
+		}
+		return insert(value).first;
+	}
+	/*
+	** The batch is copied out, stably sorted by key and merged with the
+	** current entries in one pass: O(n + m log m) instead of m shifts. As
+	** for map, keys already present (or repeated in the batch) keep their
+	** first value.
+	*/
+	template <class InputIt>
+	void insert(InputIt first, InputIt last)
+	{
+		ft::vector<pair<Key, T> > batch;
+		for (; first != last; ++first)
+			batch.push_back(pair<Key, T>((*first).first, (*first).second));
+		std::stable_sort(batch.begin(), batch.end(), value_compare(_comp));
+		KeyContainer keys;
+		MappedContainer values;
+		keys.reserve(size() + batch.size());
+		values.reserve(size() + batch.size());
+		size_type i = 0, j = 0, n = size(), m = batch.size();
+		while (i < n || j < m)
+		{
+			if (j < m && j > 0 && !_comp(batch[j - 1].first, batch[j].first))
+				++j;
+			else if (j == m || (i < n && _comp(_keys[i], batch[j].first)))
+			{
+				keys.push_back(_keys[i]);
+				values.push_back(_values[i++]);
+			}
+			else if (i == n || _comp(batch[j].first, _keys[i]))
+			{
+				keys.push_back(batch[j].first);
+				values.push_back(batch[j++].second);
+			}
+			else
+				++j;
+		}
+		_keys.swap(keys);
+		_values.swap(values);
+	}
+	void erase(iterator pos) { erase(pos, pos + 1); }
+	void erase(iterator first, iterator last)
+	{
+		size_type i = first - begin(), j = last - begin();
+		_keys.erase(_keys.begin() + i, _keys.begin() + j);
+		_values.erase(_values.begin() + i, _values.begin() + j);
+	}
+	size_type erase(const key_type &key)
+	{
+		size_type i = find_index(key);
+		if (i == size())
+			return 0;
+		erase(entry(i));
+		return 1;
+	}
+	void swap(flat_map &other)
+	{
+		std::swap(_comp, other._comp);
+		_keys.swap(other._keys);
+		_values.swap(other._values);
+	}
+
+	size_type count(const Key &key) const { return find_index(key) != size(); }
+	iterator find(const Key &key) { return entry(find_index(key)); }
+	const_iterator find(const Key &key) const { return entry(find_index(key)); }
+	pair<iterator, iterator> equal_range(const Key &key)
+	{
+		return make_pair(entry(lower_index(key)), entry(upper_index(key)));
+	}
+	pair<const_iterator, const_iterator> equal_range(const Key &key) const
+	{
+		return make_pair(entry(lower_index(key)), entry(upper_index(key)));
+	}
+	iterator lower_bound(const Key &key) { return entry(lower_index(key)); }
+	const_iterator lower_bound(const Key &key) const { return entry(lower_index(key)); }
+	iterator upper_bound(const Key &key) { return entry(upper_index(key)); }
+	const_iterator upper_bound(const Key &key) const { return entry(upper_index(key)); }
+
+	// heterogeneous lookup, for a Compare that defines is_transparent
+	template <class K>
+	typename enable_if_transparent<Compare, K, size_type>::type
+	count(const K &key) const { return find_index(key) != size(); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	find(const K &key) { return entry(find_index(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, const_iterator>::type
+	find(const K &key) const { return entry(find_index(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, pair<iterator, iterator> >::type
+	equal_range(const K &key)
+	{
+		return make_pair(entry(lower_index(key)), entry(upper_index(key)));
+	}
+	template <class K>
+	typename enable_if_transparent<Compare, K, pair<const_iterator, const_iterator> >::type
+	equal_range(const K &key) const
+	{
+		return make_pair(entry(lower_index(key)), entry(upper_index(key)));
+	}
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	lower_bound(const K &key) { return entry(lower_index(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, const_iterator>::type
+	lower_bound(const K &key) const { return entry(lower_index(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	upper_bound(const K &key) { return entry(upper_index(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, const_iterator>::type
+	upper_bound(const K &key) const { return entry(upper_index(key)); }
+
+	iterator nth(size_type k) { return entry(std::min(k, size())); }
+	const_iterator nth(size_type k) const { return entry(std::min(k, size())); }
+	size_type rank(const Key &key) const { return lower_index(key); }
+	size_type count_range(const Key &lo, const Key &hi) const
+	{
+		size_type l = lower_index(lo), h = lower_index(hi);
+		return h > l ? h - l : 0;
+	}
+	// removes the keys in [lo, hi) and returns them as a flat_map of their own
+	flat_map extract_range(const Key &lo, const Key &hi)
+	{
+		size_type l = lower_index(lo), h = std::max(l, lower_index(hi));
+		flat_map r(_comp);
+		r._keys.assign(_keys.begin() + l, _keys.begin() + h);
+		r._values.assign(_values.begin() + l, _values.begin() + h);
+		erase(entry(l), entry(h));
+		return r;
+	}
+
+	// set algebra by key; a key in both maps keeps this map's value
+	flat_map set_union(const flat_map &other) const { return merged(other, KEEP_LEFT | KEEP_RIGHT | KEEP_BOTH); }
+	flat_map set_intersection(const flat_map &other) const { return merged(other, KEEP_BOTH); }
+	flat_map set_difference(const flat_map &other) const { return merged(other, KEEP_LEFT); }
+	flat_map set_symmetric_difference(const flat_map &other) const { return merged(other, KEEP_LEFT | KEEP_RIGHT); }
+
+	key_compare key_comp() const { return _comp; }
+	value_compare value_comp() const { return value_compare(_comp); }
+	const KeyContainer &keys() const { return _keys; }
+	const MappedContainer &values() const { return _values; }
+
+private:
+	enum { KEEP_LEFT = 1, KEEP_RIGHT = 2, KEEP_BOTH = 4 };
+
+	Compare _comp;
+	KeyContainer _keys;
+	MappedContainer _values;
+
+	iterator entry(size_type i) { return iterator(_keys.data() + i, _values.data() + i); }
+	const_iterator entry(size_type i) const { return const_iterator(_keys.data() + i, _values.data() + i); }
+	void insert_at(size_type i, const Key &key, const T &value)
+	{
+		_keys.insert(_keys.begin() + i, key);
+		try { _values.insert(_values.begin() + i, value); }
+		catch (...) { _keys.erase(_keys.begin() + i); throw; }
+	}
+	// first index whose key is not less than key
+	template <class K>
+	size_type lower_index(const K &key) const
+	{
+		const Key *first = _keys.data();
+		size_type len = size();
+		while (len > 0)
+		{
+			size_type half = len / 2;
+			if (_comp(first[half], key))
+			{
+				first += half + 1;
+				len -= half + 1;
+			}
+			else
+				len = half;
+		}
+		return first - _keys.data();
+	}
+	template <class K>
+	size_type upper_index(const K &key) const
+	{
+		const Key *first = _keys.data();
+		size_type len = size();
+		while (len > 0)
+		{
+			size_type half = len / 2;
+			if (!_comp(key, first[half]))
+			{
+				first += half + 1;
+				len -= half + 1;
+			}
+			else
+				len = half;
+		}
+		return first - _keys.data();
+	}
+	// index of key, size() when absent
+	template <class K>
+	size_type find_index(const K &key) const
+	{
+		size_type i = lower_index(key);
+		return i != size() && !_comp(key, _keys[i]) ? i : size();
+	}
+	flat_map merged(const flat_map &other, int keep) const
+	{
+		flat_map r(_comp);
+		size_type i = 0, j = 0, n = size(), m = other.size();
+		while (i < n || j < m)
+			if (j == m || (i < n && _comp(_keys[i], other._keys[j])))
+			{
+				if (keep & KEEP_LEFT)
+					r.push_back(_keys[i], _values[i]);
+				++i;
+			}
+			else if (i == n || _comp(other._keys[j], _keys[i]))
+			{
+				if (keep & KEEP_RIGHT)
+					r.push_back(other._keys[j], other._values[j]);
+				++j;
+			}
+			else
+			{
+				if (keep & KEEP_BOTH)
+					r.push_back(_keys[i], _values[i]);
+				++i;
+				++j;
+			}
+		return r;
+	}
+	void push_back(const Key &key, const T &value)
+	{
+		_keys.push_back(key);
+		try { _values.push_back(value); }
+		catch (...) { _keys.pop_back(); throw; }
+	}
+};
+
+template <class Key, class T, class Compare, class KC, class MC>
+bool operator==(const ft::flat_map<Key, T, Compare, KC, MC> &lhs,
+				const ft::flat_map<Key, T, Compare, KC, MC> &rhs)
+{
+	return lhs.keys() == rhs.keys() && lhs.values() == rhs.values();
+}
+
+template <class Key, class T, class Compare, class KC, class MC>
+bool operator!=(const ft::flat_map<Key, T, Compare, KC, MC> &lhs,
+				const ft::flat_map<Key, T, Compare, KC, MC> &rhs) { return (!(lhs == rhs)); }
+
+template <class Key, class T, class Compare, class KC, class MC>
+bool operator<(const ft::flat_map<Key, T, Compare, KC, MC> &lhs,
+			   const ft::flat_map<Key, T, Compare, KC, MC> &rhs)
+{
+	typename ft::flat_map<Key, T, Compare, KC, MC>::const_iterator itl = lhs.begin();
+	typename ft::flat_map<Key, T, Compare, KC, MC>::const_iterator itr = rhs.begin();
+	while (itl != lhs.end() && itr != rhs.end() && *itl == *itr)
+	{
+		++itl;
+		++itr;
+	}
+	return (itl == lhs.end() && itr != rhs.end()) || (itl != lhs.end() && itr != rhs.end() && *itl < *itr);
+}
+
+template <class Key, class T, class Compare, class KC, class MC>
+bool operator<=(const ft::flat_map<Key, T, Compare, KC, MC> &lhs,
+				const ft::flat_map<Key, T, Compare, KC, MC> &rhs) { return (!(rhs < lhs)); }
+
+template <class Key, class T, class Compare, class KC, class MC>
+bool operator>(const ft::flat_map<Key, T, Compare, KC, MC> &lhs,
+			   const ft::flat_map<Key, T, Compare, KC, MC> &rhs) { return (rhs < lhs); }
+
+template <class Key, class T, class Compare, class KC, class MC>
+bool operator>=(const ft::flat_map<Key, T, Compare, KC, MC> &lhs,
+				const ft::flat_map<Key, T, Compare, KC, MC> &rhs) { return (!(lhs < rhs)); }
+
+template <class Key, class T, class Compare, class KC, class MC>
+void swap(ft::flat_map<Key, T, Compare, KC, MC> &lhs,
+		  ft::flat_map<Key, T, Compare, KC, MC> &rhs) { lhs.swap(rhs); }
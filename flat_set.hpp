@@ -0,0 +1,290 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include "vector.hpp"
+#include "pair.hpp"
+#include "traits.hpp"
+
+namespace ft
+{
+	template <class Key, class Compare = std::less<Key>,
+			  class KeyContainer = ft::vector<Key> >
+	class flat_set;
+}
+
+/*
+** A set over one sorted array: binary-search lookups over contiguous keys,
+** no per-entry node. Single inserts and erases shift the tail; range
+** insert sorts the batch and merges it in one pass. Any insert or erase
+** invalidates iterators.
+*/
+template <class Key, class Compare, class KeyContainer>
+class ft::flat_set
+{
+public:
+	typedef Key key_type;
+	typedef Key value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef Compare key_compare;
+	typedef Compare value_compare;
+	typedef const value_type &reference;
+	typedef const value_type &const_reference;
+	typedef KeyContainer container_type;
+
+	typedef typename KeyContainer::const_iterator iterator;
+	typedef typename KeyContainer::const_iterator const_iterator;
+	typedef typename KeyContainer::const_reverse_iterator reverse_iterator;
+	typedef typename KeyContainer::const_reverse_iterator const_reverse_iterator;
+
+	iterator begin() const { return _keys.begin(); }
+	iterator end() const { return _keys.end(); }
+	reverse_iterator rbegin() const { return _keys.rbegin(); }
+	reverse_iterator rend() const { return _keys.rend(); }
+
+	flat_set() {}
+	explicit flat_set(const Compare &comp) : _comp(comp) {}
+	template <class InputIt>
+	flat_set(InputIt first, InputIt last,
+			 const Compare &comp = Compare()) : _comp(comp) { insert(first, last); }
+	flat_set(const flat_set &other) : _comp(other._comp), _keys(other._keys) {}
+	~flat_set() {}
+	flat_set &operator=(const flat_set &other)
+	{
+		if (this == &other)
+			return *this;
+		_comp = other._comp;
+		_keys = other._keys;
+		return *this;
+	}
+
+	bool empty() const { return _keys.empty(); }
+	size_type size() const { return _keys.size(); }
+	size_type max_size() const { return _keys.max_size(); }
+	void reserve(size_type n) { _keys.reserve(n); }
+	void shrink_to_fit() { _keys.shrink_to_fit(); }
+	void clear() { _keys.clear(); }
+	pair<iterator, bool> insert(const value_type &value)
+	{
+		size_type i = lower_index(value);
+		if (i != size() && !_comp(value, _keys[i]))
+			return make_pair(entry(i), false);
+		_keys.insert(_keys.begin() + i, value);
+		return make_pair(entry(i), true);
+	}
+	// the hint is used when the value belongs right before it
+	iterator insert(iterator hint, const value_type &value)
+	{
+		size_type i = hint - begin();
+		if ((i == size() || _comp(value, _keys[i])) && (i == 0 || _comp(_keys[i - 1], value)))
+		{
+			_keys.insert(_keys.begin() + i, value);
+			return entry(i);
+		}
+		return insert(value).first;
+	}
+	// sorts the batch and merges it with the current keys in one pass
+	template <class InputIt>
+	void insert(InputIt first, InputIt last)
+	{
+		KeyContainer batch;
+		for (; first != last; ++first)
+			batch.push_back(*first);
+		std::stable_sort(batch.begin(), batch.end(), _comp);
+		KeyContainer keys;
+		keys.reserve(size() + batch.size());
+		size_type i = 0, j = 0, n = size(), m = batch.size();
+		while (i < n || j < m)
+		{
+			if (j < m && j > 0 && !_comp(batch[j - 1], batch[j]))
+				++j;
+			else if (j == m || (i < n && _comp(_keys[i], batch[j])))
+				keys.push_back(_keys[i++]);
+			else if (i == n || _comp(batch[j], _keys[i]))
+				keys.push_back(batch[j++]);
+			else
+				++j;
+		}
+		_keys.swap(keys);
+	}
+	void erase(iterator pos) { erase(pos, pos + 1); }
+	void erase(iterator first, iterator last)
+	{
+		_keys.erase(_keys.begin() + (first - begin()), _keys.begin() + (last - begin()));
+	}
+	size_type erase(const key_type &key)
+	{
+		size_type i = find_index(key);
+		if (i == size())
+			return 0;
+		erase(entry(i));
+		return 1;
+	}
+	void swap(flat_set &other)
+	{
+		std::swap(_comp, other._comp);
+		_keys.swap(other._keys);
+	}
+
+	size_type count(const Key &key) const { return find_index(key) != size(); }
+	iterator find(const Key &key) const { return entry(find_index(key)); }
+	pair<iterator, iterator> equal_range(const Key &key) const
+	{
+		return make_pair(entry(lower_index(key)), entry(upper_index(key)));
+	}
+	iterator lower_bound(const Key &key) const { return entry(lower_index(key)); }
+	iterator upper_bound(const Key &key) const { return entry(upper_index(key)); }
+
+	// heterogeneous lookup, for a Compare that defines is_transparent
+	template <class K>
+	typename enable_if_transparent<Compare, K, size_type>::type
+	count(const K &key) const { return find_index(key) != size(); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	find(const K &key) const { return entry(find_index(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, pair<iterator, iterator> >::type
+	equal_range(const K &key) const
+	{
+		return make_pair(entry(lower_index(key)), entry(upper_index(key)));
+	}
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	lower_bound(const K &key) const { return entry(lower_index(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	upper_bound(const K &key) const { return entry(upper_index(key)); }
+
+	iterator nth(size_type k) const { return entry(std::min(k, size())); }
+	size_type rank(const Key &key) const { return lower_index(key); }
+	size_type count_range(const Key &lo, const Key &hi) const
+	{
+		size_type l = lower_index(lo), h = lower_index(hi);
+		return h > l ? h - l : 0;
+	}
+	// removes the keys in [lo, hi) and returns them as a flat_set of their own
+	flat_set extract_range(const Key &lo, const Key &hi)
+	{
+		size_type l = lower_index(lo), h = std::max(l, lower_index(hi));
+		flat_set r(_comp);
+		r._keys.assign(_keys.begin() + l, _keys.begin() + h);
+		erase(entry(l), entry(h));
+		return r;
+	}
+
+	// set algebra, results are new sets
+	flat_set set_union(const flat_set &other) const { return merged(other, KEEP_LEFT | KEEP_RIGHT | KEEP_BOTH); }
+	flat_set set_intersection(const flat_set &other) const { return merged(other, KEEP_BOTH); }
+	flat_set set_difference(const flat_set &other) const { return merged(other, KEEP_LEFT); }
+	flat_set set_symmetric_difference(const flat_set &other) const { return merged(other, KEEP_LEFT | KEEP_RIGHT); }
+
+	key_compare key_comp() const { return _comp; }
+	value_compare value_comp() const { return _comp; }
+	const KeyContainer &keys() const { return _keys; }
+
+private:
+	enum { KEEP_LEFT = 1, KEEP_RIGHT = 2, KEEP_BOTH = 4 };
+
+	Compare _comp;
+	KeyContainer _keys;
+
+	iterator entry(size_type i) const { return _keys.begin() + i; }
+	// first index whose key is not less than key
+	template <class K>
+	size_type lower_index(const K &key) const
+	{
+		const Key *first = _keys.data();
+		size_type len = size();
+		while (len > 0)
+		{
+			size_type half = len / 2;
+			if (_comp(first[half], key))
+			{
+				first += half + 1;
+				len -= half + 1;
+			}
+			else
+				len = half;
+		}
+		return first - _keys.data();
+	}
+	template <class K>
+	size_type upper_index(const K &key) const
+	{
+		const Key *first = _keys.data();
+		size_type len = size();
+		while (len > 0)
+		{
+			size_type half = len / 2;
+			if (!_comp(key, first[half]))
+			{
+				first += half + 1;
+				len -= half + 1;
+			}
+			else
+				len = half;
+		}
+		return first - _keys.data();
+	}
+	// index of key, size() when absent
+	template <class K>
+	size_type find_index(const K &key) const
+	{
+		size_type i = lower_index(key);
+		return i != size() && !_comp(key, _keys[i]) ? i : size();
+	}
+	flat_set merged(const flat_set &other, int keep) const
+	{
+		flat_set r(_comp);
+		size_type i = 0, j = 0, n = size(), m = other.size();
+		while (i < n || j < m)
+			if (j == m || (i < n && _comp(_keys[i], other._keys[j])))
+			{
+				if (keep & KEEP_LEFT)
+					r._keys.push_back(_keys[i]);
+				++i;
+			}
+			else if (i == n || _comp(other._keys[j], _keys[i]))
+			{
+				if (keep & KEEP_RIGHT)
+					r._keys.push_back(other._keys[j]);
+				++j;
+			}
+			else
+			{
+				if (keep & KEEP_BOTH)
+					r._keys.push_back(_keys[i]);
+				++i;
+				++j;
+			}
+		return r;
+	}
+};
+
+template <class Key, class Compare, class KC>
+bool operator==(const ft::flat_set<Key, Compare, KC> &lhs,
+				const ft::flat_set<Key, Compare, KC> &rhs) { return lhs.keys() == rhs.keys(); }
+
+template <class Key, class Compare, class KC>
+bool operator!=(const ft::flat_set<Key, Compare, KC> &lhs,
+				const ft::flat_set<Key, Compare, KC> &rhs) { return (!(lhs == rhs)); }
+
+template <class Key, class Compare, class KC>
+bool operator<(const ft::flat_set<Key, Compare, KC> &lhs,
+			   const ft::flat_set<Key, Compare, KC> &rhs) { return lhs.keys() < rhs.keys(); }
+
+template <class Key, class Compare, class KC>
+bool operator<=(const ft::flat_set<Key, Compare, KC> &lhs,
+				const ft::flat_set<Key, Compare, KC> &rhs) { return (!(rhs < lhs)); }
+
+template <class Key, class Compare, class KC>
+bool operator>(const ft::flat_set<Key, Compare, KC> &lhs,
+			   const ft::flat_set<Key, Compare, KC> &rhs) { return (rhs < lhs); }
+
+template <class Key, class Compare, class KC>
+bool operator>=(const ft::flat_set<Key, Compare, KC> &lhs,
+				const ft::flat_set<Key, Compare, KC> &rhs) { return (!(lhs < rhs)); }
+
+template <class Key, class Compare, class KC>
+void swap(ft::flat_set<Key, Compare, KC> &lhs,
+		  ft::flat_set<Key, Compare, KC> &rhs) { lhs.swap(rhs); }
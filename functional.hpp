@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace ft
+{
+	template <class T>
+	struct hash;
+	template <class T>
+	struct identity;
+	template <class Pair>
+	struct select_first;
+	struct transparent_less;
+}
+
+// key extraction policies for rbtree: the value itself, or pair::first
+template <class T>
+struct ft::identity
+{
+	typedef T type;
+	const T &operator()(const T &x) const { return x; }
+};
+
+template <class Pair>
+struct ft::select_first
+{
+	typedef typename Pair::first_type type;
+	const type &operator()(const Pair &x) const { return x.first; }
+};
+
+/*
+** operator< over any pair of argument types. Containers keyed with it
+** accept lookups by anything comparable to the key (e.g. const char * on
+** std::string keys) without building a temporary key.
+*/
+struct ft::transparent_less
+{
+	typedef void is_transparent;
+	template <class T, class U>
+	bool operator()(const T &lhs, const U &rhs) const { return lhs < rhs; }
+};
+
+/*
+** Hash functions for the unordered containers. They only need to tell keys
+** apart: the table mixes the result itself, so integers and pointers are
+** passed through as they are. Strings use FNV-1a.
+*/
+template <class T>
+struct ft::hash
+{
+	std::size_t operator()(const T &x) const { return static_cast<std::size_t>(x); }
+};
+
+namespace ft
+{
+	template <class T>
+	struct hash<T *>
+	{
+		std::size_t operator()(T *p) const { return reinterpret_cast<std::size_t>(p); }
+	};
+	template <>
+	struct hash<std::string>
+	{
+		std::size_t operator()(const std::string &s) const
+		{
+			std::size_t h = 2166136261u;
+			for (std::size_t i = 0; i < s.size(); i++)
+				h = (h ^ static_cast<unsigned char>(s[i])) * 16777619u;
+			return h;
+		}
+	};
+}
@@ -0,0 +1,506 @@
+#pragma once
+#include <cstring>
+#include <memory>
+#include <new>
+#include <functional>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "pair.hpp"
+#include "functional.hpp"
+#include "uninitialized.hpp"
+
+namespace ft
+{
+	template <class Value, class Hash, class KeyEqual, class Allocator, class KeyOf = ft::identity<Value> >
+	class hash_table;
+}
+
+/*
+** Open addressing with SwissTable-style metadata: one control byte per
+** slot holds 7 bits of the hash (or EMPTY/DELETED), and slots are probed
+** a 16-byte group at a time, so a lookup compares one key per ~128
+** candidates on average and rarely touches a slot that doesn't match.
+** With SSE2 a group is matched with one compare and movemask.
+**
+** Growing is incremental: the full table becomes _old and every insert
+** moves one more group of it into the new _tab, so no insert pays for
+** the whole rehash. Lookups and erases look in both until _old drains.
+** Inserts may move any element, so they invalidate iterators and
+** references; erase only invalidates the erased element.
+*/
+template <class Value, class Hash, class KeyEqual, class Allocator, class KeyOf>
+class ft::hash_table
+{
+public:
+	typedef std::size_t size_type;
+	typedef typename KeyOf::type key_type;
+
+	enum { GROUP = 16 };
+
+	class const_iterator
+	{
+	public:
+		typedef typename Allocator::difference_type difference_type;
+		typedef Value value_type;
+		typedef const Value &reference;
+		typedef const Value *pointer;
+		typedef std::forward_iterator_tag iterator_category;
+
+		const_iterator() : _t(NULL), _i(0) {}
+		// the first element at or after slot i
+		const_iterator(const hash_table *t, size_type i) : _t(t), _i(i) { skip(); }
+		const_iterator(const const_iterator &other) : _t(other._t), _i(other._i) {}
+		~const_iterator() {}
+
+		const_iterator &operator=(const const_iterator &other)
+		{
+			_t = other._t;
+			_i = other._i;
+			return *this;
+		}
+		bool operator==(const const_iterator &other) const { return _i == other._i; }
+		bool operator!=(const const_iterator &other) const { return _i != other._i; }
+
+		const_iterator &operator++()
+		{
+			++_i;
+			skip();
+			return *this;
+		}
+		const_iterator operator++(int)
+		{
+			const_iterator t(*this);
+			++*this;
+			return t;
+		}
+
+		reference operator*() const { return *_t->slot(_i); }
+		pointer operator->() const { return _t->slot(_i); }
+		const hash_table *_t;
+		size_type _i;
+
+	private:
+		void skip()
+		{
+			while (_t && _i < _t->slot_count() && !_t->full(_i))
+				++_i;
+		}
+	};
+
+	class iterator : public const_iterator
+	{
+	private:
+		typedef const_iterator cit;
+
+	public:
+		typedef typename Allocator::difference_type difference_type;
+		typedef Value value_type;
+		typedef Value &reference;
+		typedef Value *pointer;
+		typedef std::forward_iterator_tag iterator_category;
+
+		iterator() : cit() {}
+		iterator(const hash_table *t, size_type i) : cit(t, i) {}
+		iterator(const iterator &other) : cit(other) {}
+		~iterator() {}
+
+		iterator &operator=(const iterator &other)
+		{
+			cit::operator=(other);
+			return *this;
+		}
+		iterator &operator++()
+		{
+			cit::operator++();
+			return *this;
+		}
+		iterator operator++(int)
+		{
+			iterator t(*this);
+			cit::operator++();
+			return t;
+		}
+
+		reference operator*() const { return *cit::_t->slot(cit::_i); }
+		pointer operator->() const { return cit::_t->slot(cit::_i); }
+	};
+
+	iterator begin() const { return iterator(this, 0); }
+	iterator end() const { return iterator(this, slot_count()); }
+
+	hash_table() : _cursor(0) {}
+	hash_table(size_type n, const Hash &hash, const KeyEqual &eq,
+			   const Allocator &alloc) : _cursor(0),
+										 _hash(hash),
+										 _eq(eq),
+										 _alloc(alloc),
+										 _ctrl_alloc(alloc)
+	{
+		reserve(n);
+	}
+	hash_table(const hash_table &other) : _cursor(0),
+										  _hash(other._hash),
+										  _eq(other._eq),
+										  _alloc(allocator_copy<value_allocator>::select(other._alloc)),
+										  _ctrl_alloc(_alloc)
+	{
+		// copy_from() only clears on a throw, and the destructor won't run
+		try { copy_from(other); }
+		catch (...)
+		{
+			release(_old);
+			release(_tab);
+			throw;
+		}
+	}
+	~hash_table()
+	{
+		release(_old);
+		release(_tab);
+	}
+	hash_table &operator=(const hash_table &other)
+	{
+		if (this == &other)
+			return *this;
+		clear();
+		copy_from(other);
+		return *this;
+	}
+
+	bool empty() const { return !size(); }
+	size_type size() const { return _tab.size + _old.size; }
+	size_type max_size() const { return _alloc.max_size(); }
+	size_type slot_count() const { return _old.cap + _tab.cap; }
+	// slots 0.._old.cap - 1 are _old's, the rest _tab's
+	bool full(size_type i) const { return i < _old.cap ? _old.ctrl[i] >= 0 : _tab.ctrl[i - _old.cap] >= 0; }
+	Value *slot(size_type i) const { return i < _old.cap ? _old.slots + i : _tab.slots + i - _old.cap; }
+	const Hash &hash_function() const { return _hash; }
+	const KeyEqual &key_eq() const { return _eq; }
+
+	// keeps the capacity, like clear() on the node-based containers
+	void clear()
+	{
+		release(_old);
+		destroy_all(_tab);
+		if (_tab.cap)
+			std::memset(_tab.ctrl, EMPTY, _tab.cap);
+		_tab.size = 0;
+		_tab.growth_left = max_load(_tab.cap);
+	}
+	void swap(hash_table &other)
+	{
+		std::swap(_tab, other._tab);
+		std::swap(_old, other._old);
+		std::swap(_cursor, other._cursor);
+		std::swap(_hash, other._hash);
+		std::swap(_eq, other._eq);
+		std::swap(_alloc, other._alloc);
+		std::swap(_ctrl_alloc, other._ctrl_alloc);
+	}
+	// room for n elements without growing; finishes any rehash in progress
+	void reserve(size_type n)
+	{
+		size_type cap = GROUP;
+		while (max_load(cap) < n)
+			cap *= 2;
+		if (_old.cap || cap > _tab.cap)
+			rehash_now(cap > _tab.cap ? cap : _tab.cap);
+	}
+
+	pair<iterator, bool> insert(const Value &value)
+	{
+		copy_value make = {value};
+		return insert_unique(KeyOf()(value), make);
+	}
+	// make(p) constructs the value at p, only once key is known to be new
+	template <class Make>
+	pair<iterator, bool> insert_unique(const key_type &key, const Make &make)
+	{
+		size_type h = mix(_hash(key));
+		size_type i = locate(key, h);
+		if (i != slot_count())
+			return make_pair(iterator(this, i), false);
+		if (_old.cap)
+			migrate_group();
+		if (!_tab.growth_left)
+			grow();
+		i = free_slot(_tab, h);
+		make(_tab.slots + i);
+		if (_tab.ctrl[i] == EMPTY)
+			--_tab.growth_left;
+		_tab.ctrl[i] = h2(h);
+		++_tab.size;
+		return make_pair(iterator(this, _old.cap + i), true);
+	}
+	template <class InputIt>
+	void insert_range(InputIt first, InputIt last)
+	{
+		for (; first != last; ++first)
+			insert(*first);
+	}
+	// returns the element after pos
+	iterator erase(const_iterator pos)
+	{
+		if (pos._i < _old.cap)
+			erase_at(_old, pos._i);
+		else
+			erase_at(_tab, pos._i - _old.cap);
+		return iterator(this, pos._i + 1);
+	}
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		while (first != last)
+			first = erase(first);
+		return iterator(this, first._i);
+	}
+	template <class K>
+	size_type erase_key(const K &key)
+	{
+		size_type i = locate(key, mix(_hash(key)));
+		if (i == slot_count())
+			return 0;
+		erase(const_iterator(this, i));
+		return 1;
+	}
+	template <class K>
+	iterator find(const K &key) const { return iterator(this, locate(key, mix(_hash(key)))); }
+
+private:
+	typedef typename Allocator::template rebind<Value>::other value_allocator;
+	typedef typename Allocator::template rebind<signed char>::other ctrl_allocator;
+	typedef uninitialized<Value, value_allocator> values;
+
+	// control bytes: a full slot holds the low 7 bits of its hash
+	enum { EMPTY = -128, DELETED = -2 };
+
+	struct table
+	{
+		table() : ctrl(NULL), slots(NULL), cap(0), size(0), growth_left(0) {}
+		signed char *ctrl;
+		Value *slots;
+		size_type cap;		   // a power of two, at least GROUP
+		size_type size;
+		size_type growth_left; // EMPTY slots that may still be filled
+	};
+	struct copy_value
+	{
+		const Value &value;
+		void operator()(Value *p) const { new (p) Value(value); }
+	};
+
+#ifdef __SSE2__
+	// bit i of each mask is set for control byte i of the group
+	struct group
+	{
+		explicit group(const signed char *p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))) {}
+		unsigned match(signed char b) const { return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(b))); }
+		unsigned match_empty() const { return match(EMPTY); }
+		// EMPTY and DELETED are the bytes with the sign bit set
+		unsigned match_free() const { return _mm_movemask_epi8(ctrl); }
+		__m128i ctrl;
+	};
+#else
+	struct group
+	{
+		explicit group(const signed char *p) : ctrl(p) {}
+		unsigned match(signed char b) const
+		{
+			unsigned m = 0;
+			for (int i = 0; i < GROUP; i++)
+				m |= unsigned(ctrl[i] == b) << i;
+			return m;
+		}
+		unsigned match_empty() const { return match(EMPTY); }
+		unsigned match_free() const
+		{
+			unsigned m = 0;
+			for (int i = 0; i < GROUP; i++)
+				m |= unsigned(ctrl[i] < 0) << i;
+			return m;
+		}
+		const signed char *ctrl;
+	};
+#endif
+
+	table _tab;
+	table _old;
+	size_type _cursor; // _old's slots below this have been moved
+	Hash _hash;
+	KeyEqual _eq;
+	value_allocator _alloc;
+	ctrl_allocator _ctrl_alloc;
+
+	// Fibonacci hashing (times 2^64/phi), high half folded down, so that
+	// the low 7 bits and the group index both depend on every input bit
+	static size_type mix(size_type h)
+	{
+		const size_type phi = (size_type(0x9E3779B9) << (sizeof(size_type) * 4)) | 0x7F4A7C15;
+		h *= phi;
+		return h ^ (h >> (sizeof(size_type) * 4));
+	}
+	static signed char h2(size_type h) { return static_cast<signed char>(h & 0x7F); }
+	static size_type max_load(size_type cap) { return cap - cap / 8; }
+	static const key_type &key_of(const Value &v) { return KeyOf()(v); }
+
+	// groups probed triangularly, which visits every group of a power-of-two table
+	template <class K>
+	size_type find_in(const table &t, const K &key, size_type h) const
+	{
+		if (!t.cap)
+			return t.cap;
+		size_type mask = t.cap / GROUP - 1, g = (h >> 7) & mask;
+		for (size_type step = 1;; g = (g + step++) & mask)
+		{
+			group grp(t.ctrl + g * GROUP);
+			for (unsigned m = grp.match(h2(h)); m; m &= m - 1)
+			{
+				size_type i = g * GROUP + __builtin_ctz(m);
+				if (_eq(key_of(t.slots[i]), key))
+					return i;
+			}
+			if (grp.match_empty())
+				return t.cap;
+		}
+	}
+	// slot index of key across both tables, slot_count() when absent
+	template <class K>
+	size_type locate(const K &key, size_type h) const
+	{
+		size_type i = find_in(_tab, key, h);
+		if (i != _tab.cap)
+			return _old.cap + i;
+		if (_old.cap && (i = find_in(_old, key, h)) != _old.cap)
+			return i;
+		return slot_count();
+	}
+	size_type free_slot(const table &t, size_type h) const
+	{
+		size_type mask = t.cap / GROUP - 1, g = (h >> 7) & mask;
+		for (size_type step = 1;; g = (g + step++) & mask)
+		{
+			unsigned m = group(t.ctrl + g * GROUP).match_free();
+			if (m)
+				return g * GROUP + __builtin_ctz(m);
+		}
+	}
+	/*
+	** A group that still has an EMPTY byte has never been full, so no probe
+	** ever went past it and the slot can be EMPTY again; otherwise it must
+	** stay DELETED to keep later keys reachable.
+	*/
+	void erase_at(table &t, size_type i)
+	{
+		values::destroy_at(_alloc, t.slots + i);
+		if (group(t.ctrl + i / GROUP * GROUP).match_empty())
+		{
+			t.ctrl[i] = EMPTY;
+			++t.growth_left;
+		}
+		else
+			t.ctrl[i] = DELETED;
+		--t.size;
+	}
+
+	void allocate(table &t, size_type cap)
+	{
+		t.slots = _alloc.allocate(cap);
+		try { t.ctrl = _ctrl_alloc.allocate(cap); }
+		catch (...)
+		{
+			_alloc.deallocate(t.slots, cap);
+			t.slots = NULL;
+			throw;
+		}
+		std::memset(t.ctrl, EMPTY, cap);
+		t.cap = cap;
+		t.size = 0;
+		t.growth_left = max_load(cap);
+	}
+	void destroy_all(table &t)
+	{
+		if (!is_trivially_destructible<Value>::value)
+			for (size_type i = 0; i < t.cap; i++)
+				if (t.ctrl[i] >= 0)
+					values::destroy_at(_alloc, t.slots + i);
+	}
+	void release(table &t)
+	{
+		if (!t.cap)
+			return;
+		destroy_all(t);
+		_alloc.deallocate(t.slots, t.cap);
+		_ctrl_alloc.deallocate(t.ctrl, t.cap);
+		t = table();
+		_cursor = 0;
+	}
+	// relocates the element in slot i of _old into _tab
+	void migrate(size_type i)
+	{
+		Value *v = _old.slots + i;
+		size_type h = mix(_hash(key_of(*v)));
+		size_type j = free_slot(_tab, h);
+		values::relocate(_alloc, _tab.slots + j, v, 1);
+		if (_tab.ctrl[j] == EMPTY)
+			--_tab.growth_left;
+		_tab.ctrl[j] = h2(h);
+		++_tab.size;
+		_old.ctrl[i] = DELETED;
+		--_old.size;
+	}
+	void migrate_group()
+	{
+		for (size_type end = _cursor + GROUP; _cursor < end; ++_cursor)
+			if (_old.ctrl[_cursor] >= 0)
+				migrate(_cursor);
+		if (_cursor == _old.cap)
+			release(_old);
+	}
+	/*
+	** _tab is out of EMPTY slots: it becomes _old, to be drained into a
+	** table twice its size, or the same size when it's mostly tombstones.
+	** The new table has room for everything in _old plus the inserts made
+	** while it drains, one group each.
+	*/
+	void grow()
+	{
+		if (!_tab.cap)
+			return allocate(_tab, GROUP);
+		while (_old.cap)
+			migrate_group();
+		size_type cap = _tab.size * 2 <= max_load(_tab.cap) ? _tab.cap : _tab.cap * 2;
+		table fresh;
+		allocate(fresh, cap);
+		_old = _tab;
+		_tab = fresh;
+		_cursor = 0;
+		migrate_group();
+	}
+	void rehash_now(size_type cap)
+	{
+		table fresh;
+		allocate(fresh, cap);
+		table old = _tab;
+		_tab = fresh;
+		while (_old.cap)
+			migrate_group();
+		_old = old;
+		_cursor = 0;
+		while (_old.cap)
+			migrate_group();
+	}
+	void copy_from(const hash_table &other)
+	{
+		try
+		{
+			reserve(other.size());
+			for (const_iterator it = other.begin(); it != other.end(); ++it)
+				insert(*it);
+		}
+		catch (...)
+		{
+			clear();
+			throw;
+		}
+	}
+};
@@ -36,6 +36,7 @@ namespace ft = std;
 #include "map.hpp"
 #include "set.hpp"
 #include "stack.hpp"
+#include "deque.hpp"
 #include "vector.hpp"
 #endif
 
@@ -51,6 +52,14 @@ struct Buffer
 
 #define COUNT (MAX_RAM / (int)sizeof(Buffer))
 
+// a comparator with state: assignment and swap have to carry it along
+struct Order
+{
+	Order(bool desc = false) : desc(desc) {}
+	bool operator()(int lhs, int rhs) const { return desc ? rhs < lhs : lhs < rhs; }
+	bool desc;
+};
+
 template <typename T>
 class MutantStack : public ft::stack<T>
 {
@@ -282,11 +291,45 @@ int main(int argc, char **argv)
 	set_print(set_iter);
 	set_print(set_def);
 
+	ft::map<int, int, Order> map_asc, map_desc(Order(true));
+	for (int i = 0; i < 5; i++)
+	{
+		map_asc[i] = i;
+		map_desc[i] = -i;
+	}
+	map_desc = map_asc;
+	map_desc[10] = 10;
+	map_desc[-1] = -1;
+	map_print(map_desc);
+	ft::map<int, int, Order> map_rev(Order(true));
+	map_rev[7] = 7;
+	map_rev[8] = 8;
+	map_asc.swap(map_rev);
+	map_asc[5] = 5;
+	map_rev[-3] = -3;
+	map_print(map_asc);
+	map_print(map_rev);
+	ft::set<int, Order> set_asc, set_desc(Order(true));
+	set_desc.insert(2);
+	set_desc.insert(1);
+	set_asc.insert(5);
+	set_asc = set_desc;
+	set_asc.insert(3);
+	set_asc.insert(0);
+	set_print(set_asc);
+	ft::set<int, Order> set_up;
+	set_up.insert(9);
+	set_up.swap(set_desc);
+	set_up.insert(4);
+	set_desc.insert(-4);
+	set_print(set_up);
+	set_print(set_desc);
+
 	ft::vector<std::string> vector_str;
 	ft::vector<int> vector_int;
 	ft::stack<int> stack_int;
 	ft::vector<Buffer> vector_buffer;
-	ft::stack<Buffer, std::deque<int> > stack_deq_buffer;
+	ft::stack<Buffer, ft::deque<Buffer> > stack_deq_buffer;
 	ft::map<int, int> map_int;
 	ft::set<int> set_int;
 
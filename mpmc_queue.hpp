@@ -0,0 +1,197 @@
+#pragma once
+#include <memory>
+#include <new>
+
+namespace ft
+{
+	template <class T, class Allocator = std::allocator<T> >
+	class mpmc_queue;
+}
+
+/*
+** Bounded FIFO for many producers and many consumers (Vyukov's queue):
+** one contiguous ring of cells, each with a sequence number that says
+** whose turn it is. A producer claims the next ticket by CAS, then fills
+** the cell and bumps its sequence to hand it to the consumer with the
+** same ticket; consumers do the reverse. Nothing is allocated after
+** construction and no thread ever waits for another. push() fails when
+** the ring is full and pop() when it's empty; the batched calls claim
+** as many cells as are ready with one CAS. A copy that throws still
+** hands on every cell claimed: the cell of a push that threw is passed
+** over empty, and the values a pop could not copy out are destroyed.
+*/
+template <class T, class Allocator>
+class ft::mpmc_queue
+{
+public:
+	typedef T value_type;
+	typedef std::size_t size_type;
+	typedef Allocator allocator_type;
+
+	// the capacity is rounded up to a power of two
+	explicit mpmc_queue(size_type capacity, const Allocator &alloc = Allocator()) : _alloc(alloc)
+	{
+		_mask = 1;
+		while (_mask < capacity)
+			_mask <<= 1;
+		_cells = _alloc.allocate(_mask);
+		for (size_type i = 0; i < _mask; i++)
+			_cells[i].seq = i;
+		_mask--;
+		_tail = _head = 0;
+	}
+	// no other thread may be using the queue
+	~mpmc_queue()
+	{
+		for (; _head != _tail; _head++)
+			if (_cells[_head & _mask].full)
+				_cells[_head & _mask].value.~T();
+		_alloc.deallocate(_cells, _mask + 1);
+	}
+	allocator_type get_allocator() const { return _alloc; }
+	size_type capacity() const { return _mask + 1; }
+
+	// false, pushing nothing, when the queue is full
+	bool push(const T &value) { return push(&value, &value + 1) != &value; }
+	// pushes from first on while there's room; returns the first one not pushed.
+	// If a copy throws, the values before it are pushed and the rest are not.
+	template <class ForwardIt>
+	ForwardIt push(ForwardIt first, ForwardIt last)
+	{
+		size_type pos = __atomic_load_n(&_tail, __ATOMIC_RELAXED), k;
+		for (;;)
+		{
+			k = 0;
+			for (ForwardIt it = first; it != last && k <= _mask && ready(pos + k, 0); ++it)
+				k++;
+			if (!k)
+			{
+				// the first cell may be a lagging consumer's rather than free
+				size_type now = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+				if (now == pos)
+					return first;
+				pos = now;
+				continue;
+			}
+			if (__atomic_compare_exchange_n(&_tail, &pos, pos + k, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		}
+		size_type i = 0;
+		try
+		{
+			for (; i < k; i++, ++first)
+			{
+				cell &c = _cells[(pos + i) & _mask];
+				new (&c.value) T(*first);
+				c.full = true;
+				__atomic_store_n(&c.seq, pos + i + 1, __ATOMIC_RELEASE);
+			}
+		}
+		catch (...)
+		{
+			// the consumers of these tickets are owed a cell, if an empty one
+			for (; i < k; i++)
+			{
+				cell &c = _cells[(pos + i) & _mask];
+				c.full = false;
+				__atomic_store_n(&c.seq, pos + i + 1, __ATOMIC_RELEASE);
+			}
+			throw;
+		}
+		return first;
+	}
+	// false when the queue is empty
+	bool pop(T &out) { return pop(&out, 1) == 1; }
+	// pops up to n values in one go, the oldest first; returns how many.
+	// If copying one out throws, it and the rest of the batch are dropped.
+	template <class OutputIt>
+	size_type pop(OutputIt out, size_type n)
+	{
+		size_type got = 0;
+		// a batch of nothing but empty cells is no answer: claim again
+		while (!got)
+		{
+			size_type pos = __atomic_load_n(&_head, __ATOMIC_RELAXED), k;
+			for (;;)
+			{
+				k = 0;
+				while (k < n && k <= _mask && ready(pos + k, 1))
+					k++;
+				if (!k)
+				{
+					size_type now = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+					if (now == pos)
+						return 0;
+					pos = now;
+					continue;
+				}
+				if (__atomic_compare_exchange_n(&_head, &pos, pos + k, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+					break;
+			}
+			size_type i = 0;
+			try
+			{
+				for (; i < k; i++)
+				{
+					cell &c = _cells[(pos + i) & _mask];
+					if (c.full)
+					{
+						*out++ = c.value;
+						got++;
+						c.value.~T();
+					}
+					__atomic_store_n(&c.seq, pos + i + _mask + 1, __ATOMIC_RELEASE);
+				}
+			}
+			catch (...)
+			{
+				// the producers of the next round are owed these cells, emptied
+				for (; i < k; i++)
+				{
+					cell &c = _cells[(pos + i) & _mask];
+					if (c.full)
+						c.value.~T();
+					__atomic_store_n(&c.seq, pos + i + _mask + 1, __ATOMIC_RELEASE);
+				}
+				throw;
+			}
+		}
+		return got;
+	}
+	// a guess while other threads are at it
+	size_type size() const
+	{
+		size_type head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+		size_type tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+		return tail > head ? tail - head : 0;
+	}
+	bool empty() const { return size() == 0; }
+
+private:
+	struct cell
+	{
+		size_type seq;	// ticket for the producer when equal, ticket + 1 for the consumer
+		bool full;		// false when the push of this ticket threw, leaving value unbuilt
+		T value;
+	};
+	typedef typename Allocator::template rebind<cell>::other cell_allocator;
+
+	mpmc_queue(const mpmc_queue &);
+	mpmc_queue &operator=(const mpmc_queue &);
+
+	// whether the cell of ticket pos is the producer's (full 0) or the consumer's (full 1) turn
+	bool ready(size_type pos, size_type full) const
+	{
+		return __atomic_load_n(&_cells[pos & _mask].seq, __ATOMIC_ACQUIRE) == pos + full;
+	}
+
+	cell *_cells;
+	size_type _mask;
+	cell_allocator _alloc;
+	// the two ends on cache lines of their own
+	char _pad0[64];
+	size_type _tail;
+	char _pad1[64];
+	size_type _head;
+	char _pad2[64];
+};
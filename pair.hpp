@@ -18,6 +18,8 @@ struct ft::pair
 	pair() : first(T1()), second(T2()) {}
 	pair(const T1 &x, const T2 &y) : first(x), second(y) {}
 	template <class U1, class U2>
+	pair(const U1 &x, const U2 &y) : first(x), second(y) {}
+	template <class U1, class U2>
 	pair(const pair<U1, U2> &p) : first(p.first), second(p.second) {}
 	pair(const pair &p) : first(p.first), second(p.second) {}
 	pair &operator=(const pair &other)
@@ -0,0 +1,182 @@
+#pragma once
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace ft
+{
+	unsigned hardware_threads();
+	template <class Job>
+	void run_parallel(Job *jobs, std::size_t n, unsigned threads);
+	bool run_background(void (*fn)(void *), void *arg);
+	struct job_error;
+}
+
+// online cores, at least 1
+inline unsigned ft::hardware_threads()
+{
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? unsigned(n) : 1;
+}
+
+namespace ft
+{
+	template <class Job>
+	struct job_queue
+	{
+		Job *jobs;
+		std::size_t n;
+		std::size_t next;
+
+		static void *work(void *arg)
+		{
+			job_queue *q = static_cast<job_queue *>(arg);
+			for (std::size_t i; (i = __atomic_fetch_add(&q->next, 1, __ATOMIC_RELAXED)) < q->n;)
+				q->jobs[i]();
+			return NULL;
+		}
+	};
+	// the calls waiting for the background thread, oldest first
+	struct background_queue
+	{
+		struct call
+		{
+			void (*fn)(void *);
+			void *arg;
+			call *next;
+		};
+		pthread_mutex_t lock;
+		pthread_cond_t wake;
+		call *head;
+		call *tail;
+		bool started;
+
+		// one for the whole program
+		static background_queue &get()
+		{
+			static background_queue q = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL, false};
+			return q;
+		}
+		static void *work(void *)
+		{
+			background_queue &q = get();
+			for (;;)
+			{
+				pthread_mutex_lock(&q.lock);
+				while (!q.head)
+					pthread_cond_wait(&q.wake, &q.lock);
+				call *c = q.head;
+				q.head = c->next;
+				if (!q.head)
+					q.tail = NULL;
+				pthread_mutex_unlock(&q.lock);
+				c->fn(c->arg);
+				delete c;
+			}
+			return NULL;
+		}
+	};
+}
+
+/*
+** Runs jobs[0], ..., jobs[n - 1] on up to threads threads, the caller's
+** among them, and returns once all are done. Each thread takes the next
+** job off a shared counter, so a few big jobs and many small ones even
+** out. Threads that can't be started are simply done without. The jobs
+** must not throw.
+*/
+template <class Job>
+void ft::run_parallel(Job *jobs, std::size_t n, unsigned threads)
+{
+	job_queue<Job> q = {jobs, n, 0};
+	if (threads > n)
+		threads = unsigned(n);
+	pthread_t ids[64];
+	unsigned started = 0;
+	while (started + 1 < threads && started < sizeof(ids) / sizeof(*ids) &&
+		   !pthread_create(&ids[started], NULL, job_queue<Job>::work, &q))
+		started++;
+	job_queue<Job>::work(&q);
+	for (unsigned i = 0; i < started; i++)
+		pthread_join(ids[i], NULL);
+}
+
+/*
+** The first exception the jobs of a run threw, caught inside the job (which
+** must not throw) and rethrown by the caller once run_parallel returns.
+** Before C++11 an exception can't be carried to another thread, only
+** whether it was a bad_alloc; rethrow() returns for anything else, and the
+** caller has to make up for it.
+*/
+struct ft::job_error
+{
+	job_error() : thrown(false), bad_alloc(false) {}
+	bool thrown;
+	bool bad_alloc;
+#if __cplusplus >= 201103L
+	std::exception_ptr error;
+#endif
+
+	// from a catch block
+	void catch_current()
+	{
+		if (__atomic_exchange_n(&thrown, true, __ATOMIC_RELAXED))
+			return;
+#if __cplusplus >= 201103L
+		error = std::current_exception();
+#else
+		try { throw; }
+		catch (const std::bad_alloc &) { bad_alloc = true; }
+		catch (...) {}
+#endif
+	}
+	void rethrow() const
+	{
+#if __cplusplus >= 201103L
+		std::rethrow_exception(error);
+#else
+		if (bad_alloc)
+			throw std::bad_alloc();
+#endif
+	}
+};
+
+/*
+** Queues fn(arg) for the background thread, one for the whole program,
+** started on first use and never waited for; calls run one at a time in
+** the order queued. False, queueing nothing, if the thread can't be
+** started.
+*/
+inline bool ft::run_background(void (*fn)(void *), void *arg)
+{
+	background_queue &q = background_queue::get();
+	background_queue::call *c = new background_queue::call;
+	c->fn = fn;
+	c->arg = arg;
+	c->next = NULL;
+	pthread_mutex_lock(&q.lock);
+	if (!q.started)
+	{
+		pthread_attr_t attr;
+		pthread_t id;
+		if (!pthread_attr_init(&attr))
+		{
+			q.started = !pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) &&
+						!pthread_create(&id, &attr, background_queue::work, NULL);
+			pthread_attr_destroy(&attr);
+		}
+		if (!q.started)
+		{
+			pthread_mutex_unlock(&q.lock);
+			delete c;
+			return false;
+		}
+	}
+	(q.tail ? q.tail->next : q.head) = c;
+	q.tail = c;
+	pthread_cond_signal(&q.wake);
+	pthread_mutex_unlock(&q.lock);
+	return true;
+}
@@ -0,0 +1,555 @@
+#pragma once
+#include <memory>
+#include <new>
+#include <climits>
+#include <iterator>
+#include <stdexcept>
+#include <functional>
+#include "pair.hpp"
+#include "epoch.hpp"
+
+namespace ft
+{
+	template <class Key, class T, class Compare = std::less<Key>,
+			  class Allocator = std::allocator<pair<const Key, T> > >
+	class persistent_map;
+}
+
+/*
+** Ordered map for one writer and any number of readers. The tree is a
+** persistent red-black tree: nodes are never changed once published, so
+** an update copies the O(log n) nodes on its path (Kahrs' insert and
+** delete) and shares everything else with the previous version.
+** get_snapshot() hands out a version in O(1) and never waits for the writer,
+** nor makes it wait; count() and find() read the current version the
+** same way.
+**
+** Nodes are reference counted: a snapshot holds its root, every node its
+** children. The writer's reference to a replaced root goes through the
+** epoch domain, so a reader that has just loaded the root can still take
+** its reference. Snapshots drop their nodes from whichever thread lets go
+** of them last, hence a thread-safe allocator (std::allocator) by default.
+** Updates must come from one thread at a time, and no snapshot may
+** outlive the map.
+*/
+template <class Key, class T, class Compare, class Allocator>
+class ft::persistent_map
+{
+public:
+	typedef Key key_type;
+	typedef T mapped_type;
+	typedef pair<const Key, T> value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef Compare key_compare;
+	typedef Allocator allocator_type;
+	typedef const value_type &const_reference;
+
+private:
+	struct node
+	{
+		value_type value;
+		node *left;
+		node *right;
+		size_type weight;	// nodes in the subtree
+		unsigned long ver;	// the update that built it; only that update may change it
+		int refs;
+		bool red;
+	};
+	typedef typename Allocator::template rebind<node>::other node_allocator;
+
+public:
+	class snapshot;
+
+	// in-order walk of a snapshot, with the path to the current node on a stack
+	class const_iterator
+	{
+	public:
+		typedef std::ptrdiff_t difference_type;
+		typedef persistent_map::value_type value_type;
+		typedef const value_type &reference;
+		typedef const value_type *pointer;
+		typedef std::forward_iterator_tag iterator_category;
+
+		const_iterator() : _depth(0) {}
+
+		bool operator==(const const_iterator &other) const { return current() == other.current(); }
+		bool operator!=(const const_iterator &other) const { return current() != other.current(); }
+
+		const_iterator &operator++()
+		{
+			node *n = _path[--_depth]->right;
+			descend(n);
+			return *this;
+		}
+		const_iterator operator++(int)
+		{
+			const_iterator t(*this);
+			++*this;
+			return t;
+		}
+
+		reference operator*() const { return current()->value; }
+		pointer operator->() const { return &current()->value; }
+
+	private:
+		friend class snapshot;
+		// a red-black tree is at most twice as deep as a perfect one
+		enum { MAX_DEPTH = 2 * CHAR_BIT * sizeof(void *) };
+
+		node *current() const { return _depth ? _path[_depth - 1] : NULL; }
+		void descend(node *n)
+		{
+			for (; n; n = n->left)
+				_path[_depth++] = n;
+		}
+
+		node *_path[MAX_DEPTH];
+		int _depth;
+	};
+	typedef const_iterator iterator;
+
+	/*
+	** One version of the map, frozen: later updates don't show through.
+	** Copies share it. Iterators are valid as long as the snapshot they
+	** came from is.
+	*/
+	class snapshot
+	{
+	public:
+		snapshot(const snapshot &other) : _m(other._m), _root(share(other._root)) {}
+		~snapshot() { _m->release(_root); }
+		snapshot &operator=(const snapshot &other)
+		{
+			node *r = share(other._root);
+			_m->release(_root);
+			_m = other._m;
+			_root = r;
+			return *this;
+		}
+
+		const_iterator begin() const
+		{
+			const_iterator it;
+			it.descend(_root);
+			return it;
+		}
+		const_iterator end() const { return const_iterator(); }
+
+		bool empty() const { return !_root; }
+		size_type size() const { return weight(_root); }
+		size_type count(const Key &key) const { return !!_m->find_in(_root, key); }
+		const T &at(const Key &key) const
+		{
+			node *n = _m->find_in(_root, key);
+			if (n)
+				return n->value.second;
+			throw std::out_of_range("no element with key");
+		}
+		const_iterator find(const Key &key) const
+		{
+			const_iterator it = lower_bound(key);
+			if (it != end() && _m->_comp(key, it->first))
+				return end();
+			return it;
+		}
+		// the path to the first key not less than key is the one the search takes
+		const_iterator lower_bound(const Key &key) const
+		{
+			const_iterator it;
+			int keep = 0;
+			for (node *n = _root; n;)
+				if (_m->_comp(n->value.first, key))
+					n = n->right;
+				else
+				{
+					it._path[it._depth++] = n;
+					keep = it._depth;
+					n = n->left;
+				}
+			it._depth = keep;
+			return it;
+		}
+
+	private:
+		friend class persistent_map;
+		snapshot(const persistent_map *m, node *root) : _m(m), _root(root) {}
+
+		const persistent_map *_m;
+		node *_root;
+	};
+
+	explicit persistent_map(const Compare &comp = Compare(),
+							const Allocator &alloc = Allocator()) : _root(NULL),
+																	_ver(0),
+																	_comp(comp),
+																	_alloc(alloc) {}
+	// no other thread may be using the map, and no snapshot be left
+	~persistent_map() { release(_root); }
+	allocator_type get_allocator() const { return _alloc; }
+
+	// the current version, from any thread
+	snapshot get_snapshot() const
+	{
+		epoch::guard pin(_epoch);
+		return snapshot(this, share(__atomic_load_n(&_root, __ATOMIC_ACQUIRE)));
+	}
+	size_type size() const
+	{
+		epoch::guard pin(_epoch);
+		return weight(__atomic_load_n(&_root, __ATOMIC_ACQUIRE));
+	}
+	bool empty() const { return size() == 0; }
+	size_type count(const Key &key) const
+	{
+		epoch::guard pin(_epoch);
+		return !!find_in(__atomic_load_n(&_root, __ATOMIC_ACQUIRE), key);
+	}
+	// copies the mapped value out; false if key isn't there
+	bool find(const Key &key, T &out) const
+	{
+		epoch::guard pin(_epoch);
+		node *n = find_in(__atomic_load_n(&_root, __ATOMIC_ACQUIRE), key);
+		if (!n)
+			return false;
+		out = n->value.second;
+		return true;
+	}
+
+	// the updates, from the writer only; false, changing nothing, when key is there already
+	bool insert(const value_type &value)
+	{
+		if (find_in(_root, value.first))
+			return false;
+		_ver++;
+		publish(blacken(ins(share(_root), value)));
+		return true;
+	}
+	// true if key is new
+	template <class M>
+	bool insert_or_assign(const Key &key, const M &obj)
+	{
+		if (!find_in(_root, key))
+			return insert(value_type(key, obj));
+		_ver++;
+		publish(assign(share(_root), key, obj));
+		return false;
+	}
+	size_type erase(const Key &key)
+	{
+		if (!find_in(_root, key))
+			return 0;
+		_ver++;
+		publish(blacken(del(share(_root), key)));
+		return 1;
+	}
+	void clear() { publish(NULL); }
+
+	key_compare key_comp() const { return _comp; }
+
+private:
+	persistent_map(const persistent_map &);
+	persistent_map &operator=(const persistent_map &);
+
+	static size_type weight(const node *n) { return n ? n->weight : 0; }
+	static bool is_red(const node *n) { return n && n->red; }
+	static bool is_black(const node *n) { return n && !n->red; }
+	static node *fix(node *n)
+	{
+		n->weight = 1 + weight(n->left) + weight(n->right);
+		return n;
+	}
+	static node *share(node *n)
+	{
+		if (n)
+			__atomic_add_fetch(&n->refs, 1, __ATOMIC_RELAXED);
+		return n;
+	}
+	void release(node *n) const
+	{
+		if (!n || __atomic_sub_fetch(&n->refs, 1, __ATOMIC_ACQ_REL))
+			return;
+		release(n->left);
+		release(n->right);
+		n->value.~value_type();
+		_alloc.deallocate(n, 1);
+	}
+	static void reclaim(void *map, void *n)
+	{
+		static_cast<const persistent_map *>(map)->release(static_cast<node *>(n));
+	}
+	// swaps in the new version; the old root's reference waits for the readers
+	void publish(node *root)
+	{
+		epoch::guard pin(_epoch);
+		node *old = _root;
+		__atomic_store_n(&_root, root, __ATOMIC_RELEASE);
+		if (old)
+			_epoch.retire(old, reclaim, this);
+	}
+
+	node *create(const value_type &value, bool red, node *left, node *right)
+	{
+		node *n = _alloc.allocate(1);
+		try { new (&n->value) value_type(value); }
+		catch (...) { _alloc.deallocate(n, 1); throw; }
+		n->left = left;
+		n->right = right;
+		n->ver = _ver;
+		n->refs = 1;
+		n->red = red;
+		return fix(n);
+	}
+	/*
+	** The rest works on references it owns: it takes them, and returns one
+	** for the tree it built. edit() turns one into a node this update may
+	** change, copying it unless this update built it.
+	*/
+	node *edit(node *n)
+	{
+		if (n->ver == _ver)
+			return n;
+		node *c = create(n->value, n->red, share(n->left), share(n->right));
+		c->weight = n->weight;
+		release(n);
+		return c;
+	}
+	node *blacken(node *n)
+	{
+		if (!is_red(n))
+			return n;
+		n = edit(n);
+		n->red = false;
+		return n;
+	}
+	node *find_in(node *n, const Key &key) const
+	{
+		while (n)
+			if (_comp(key, n->value.first))
+				n = n->left;
+			else if (_comp(n->value.first, key))
+				n = n->right;
+			else
+				return n;
+		return NULL;
+	}
+
+	// key isn't in n
+	node *ins(node *n, const value_type &value)
+	{
+		if (!n)
+			return create(value, true, NULL, NULL);
+		n = edit(n);
+		if (_comp(value.first, n->value.first))
+			n->left = ins(n->left, value);
+		else
+			n->right = ins(n->right, value);
+		return balance(n);
+	}
+	// key is in n
+	template <class M>
+	node *assign(node *n, const Key &key, const M &obj)
+	{
+		n = edit(n);
+		if (_comp(key, n->value.first))
+			n->left = assign(n->left, key, obj);
+		else if (_comp(n->value.first, key))
+			n->right = assign(n->right, key, obj);
+		else
+			n->value.second = obj;
+		return n;
+	}
+	// a black n with a red child and grandchild becomes a red node over two black ones
+	node *balance(node *n)
+	{
+		node *top;
+		if (n->red)
+			return fix(n);
+		if (is_red(n->left) && is_red(n->right))
+		{
+			// Kahrs' extra case, which the delete relies on: just recolor
+			n->left = edit(n->left);
+			n->right = edit(n->right);
+			n->left->red = false;
+			n->right->red = false;
+			n->red = true;
+			return fix(n);
+		}
+		if (is_red(n->left) && is_red(n->left->left))
+		{
+			top = n->left = edit(n->left);
+			top->left = edit(top->left);
+			n->left = top->right;
+			top->right = n;
+			top->left->red = false;
+		}
+		else if (is_red(n->left) && is_red(n->left->right))
+		{
+			node *l = n->left = edit(n->left);
+			top = l->right = edit(l->right);
+			l->right = top->left;
+			n->left = top->right;
+			top->left = fix(l);
+			top->right = n;
+			l->red = false;
+		}
+		else if (is_red(n->right) && is_red(n->right->right))
+		{
+			top = n->right = edit(n->right);
+			top->right = edit(top->right);
+			n->right = top->left;
+			top->left = n;
+			top->right->red = false;
+		}
+		else if (is_red(n->right) && is_red(n->right->left))
+		{
+			node *r = n->right = edit(n->right);
+			top = r->left = edit(r->left);
+			r->left = top->right;
+			n->right = top->left;
+			top->right = fix(r);
+			top->left = n;
+			r->red = false;
+		}
+		else
+			return fix(n);
+		fix(n);
+		top->red = true;
+		return fix(top);
+	}
+
+	// key is in n; the result is one black node short when n was black
+	node *del(node *n, const Key &key)
+	{
+		if (_comp(key, n->value.first))
+		{
+			bool short_left = is_black(n->left);
+			n = edit(n);
+			n->left = del(n->left, key);
+			if (short_left)
+				return rebalance_left(n);
+			n->red = true;
+			return fix(n);
+		}
+		if (_comp(n->value.first, key))
+		{
+			bool short_right = is_black(n->right);
+			n = edit(n);
+			n->right = del(n->right, key);
+			if (short_right)
+				return rebalance_right(n);
+			n->red = true;
+			return fix(n);
+		}
+		node *l = share(n->left), *r = share(n->right);
+		release(n);
+		return fuse(l, r);
+	}
+	// n's left subtree is one black node short (Kahrs' balleft)
+	node *rebalance_left(node *n)
+	{
+		if (is_red(n->left))
+		{
+			n->left = edit(n->left);
+			n->left->red = false;
+			n->red = true;
+			return fix(n);
+		}
+		if (is_black(n->right))
+		{
+			n->right = edit(n->right);
+			n->right->red = true;
+			n->red = false;
+			return balance(n);
+		}
+		node *r = n->right = edit(n->right);
+		node *top = r->left = edit(r->left);
+		n->right = top->left;
+		r->left = top->right;
+		r->right = redden(r->right);
+		r->red = false;
+		n->red = false;
+		top->left = fix(n);
+		top->right = balance(r);
+		top->red = true;
+		return fix(top);
+	}
+	node *rebalance_right(node *n)
+	{
+		if (is_red(n->right))
+		{
+			n->right = edit(n->right);
+			n->right->red = false;
+			n->red = true;
+			return fix(n);
+		}
+		if (is_black(n->left))
+		{
+			n->left = edit(n->left);
+			n->left->red = true;
+			n->red = false;
+			return balance(n);
+		}
+		node *l = n->left = edit(n->left);
+		node *top = l->right = edit(l->right);
+		n->left = top->right;
+		l->right = top->left;
+		l->left = redden(l->left);
+		l->red = false;
+		n->red = false;
+		top->right = fix(n);
+		top->left = balance(l);
+		top->red = true;
+		return fix(top);
+	}
+	node *redden(node *n)
+	{
+		n = edit(n);
+		n->red = true;
+		return n;
+	}
+	// joins the subtrees of a removed node, l's keys all below r's (Kahrs' app)
+	node *fuse(node *l, node *r)
+	{
+		if (!l)
+			return r;
+		if (!r)
+			return l;
+		if (!l->red && r->red)
+		{
+			r = edit(r);
+			r->left = fuse(l, r->left);
+			return fix(r);
+		}
+		if (l->red && !r->red)
+		{
+			l = edit(l);
+			l->right = fuse(l->right, r);
+			return fix(l);
+		}
+		l = edit(l);
+		r = edit(r);
+		node *mid = fuse(l->right, r->left);
+		if (is_red(mid))
+		{
+			mid = edit(mid);
+			l->right = mid->left;
+			r->left = mid->right;
+			mid->left = fix(l);
+			mid->right = fix(r);
+			return fix(mid);
+		}
+		r->left = mid;
+		l->right = fix(r);
+		if (l->red)
+			return fix(l);
+		return rebalance_left(l);
+	}
+
+	node *_root;
+	unsigned long _ver;
+	Compare _comp;
+	mutable node_allocator _alloc;
+	// last, so that it drops the retired roots while _alloc is still there
+	mutable epoch _epoch;
+};
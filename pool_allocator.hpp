@@ -0,0 +1,175 @@
+#pragma once
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include "traits.hpp"
+
+namespace ft
+{
+	template <class T>
+	class pool_allocator;
+}
+
+/*
+** Single-object allocations are carved out of large slabs and recycled
+** through a free list; anything else goes straight to operator new.
+** The pool is created on the first allocation; copies taken after that
+** share it (reference counted), so nodes may be released through any of
+** them. Slabs are returned only when the last copy goes away. Not thread
+** safe, like the containers using it.
+*/
+template <class T>
+class ft::pool_allocator
+{
+public:
+	typedef T value_type;
+	typedef T *pointer;
+	typedef const T *const_pointer;
+	typedef T &reference;
+	typedef const T &const_reference;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	template <class U>
+	struct rebind { typedef pool_allocator<U> other; };
+
+	pool_allocator() : _pool(NULL) {}
+	pool_allocator(const pool_allocator &other) : _pool(other._pool)
+	{
+		if (_pool)
+			++_pool->refs;
+	}
+	template <class U>
+	pool_allocator(const pool_allocator<U> &) : _pool(NULL) {}
+	~pool_allocator() { release(); }
+	pool_allocator &operator=(const pool_allocator &other)
+	{
+		if (other._pool)
+			++other._pool->refs;
+		release();
+		_pool = other._pool;
+		return (*this);
+	}
+
+	pointer address(reference x) const { return &x; }
+	const_pointer address(const_reference x) const { return &x; }
+	pointer allocate(size_type n, const void * = 0)
+	{
+		if (n != 1)
+			return static_cast<pointer>(::operator new(n * sizeof(T)));
+		if (!_pool)
+			_pool = new pool();
+		if (!_pool->free)
+			grow();
+		block *b = _pool->free;
+		_pool->free = b->next;
+		return reinterpret_cast<pointer>(b);
+	}
+	void deallocate(pointer p, size_type n)
+	{
+		if (n != 1)
+			return ::operator delete(p);
+		block *b = reinterpret_cast<block *>(p);
+		b->next = _pool->free;
+		_pool->free = b;
+	}
+	size_type max_size() const { return std::allocator<T>().max_size(); }
+#if __cplusplus >= 201103L
+	template <class U, class... Args>
+	void construct(U *p, Args &&...args) { ::new ((void *)p) U(std::forward<Args>(args)...); }
+	template <class U>
+	void destroy(U *p) { p->~U(); }
+#else
+	void construct(pointer p, const T &val) { new (p) T(val); }
+	void destroy(pointer p) { p->~T(); }
+#endif
+
+	// takes over the memory of other's pool, which no other copy may share, leaving it empty
+	void splice(pool_allocator &other)
+	{
+		pool *p = other._pool;
+		if (!p || p == _pool)
+			return;
+		if (!_pool)
+			_pool = new pool();
+		prepend(_pool->slabs, p->slabs);
+		prepend(_pool->free, p->free);
+		if (p->slab_size > _pool->slab_size)
+			_pool->slab_size = p->slab_size;
+		p->slabs = p->free = NULL;
+	}
+
+	bool operator==(const pool_allocator &other) const { return _pool == other._pool; }
+	bool operator!=(const pool_allocator &other) const { return _pool != other._pool; }
+
+private:
+	enum { MIN_SLAB = 16, MAX_SLAB = 4096 };
+	union block
+	{
+		block *next;
+		char storage[sizeof(T)];
+	};
+	struct pool
+	{
+		pool() : refs(1), free(NULL), slabs(NULL), slab_size(MIN_SLAB) {}
+		std::size_t refs;
+		block *free;
+		block *slabs;
+		std::size_t slab_size;
+	};
+	pool *_pool;
+
+	// the first block of every slab links it into the slab list
+	void grow()
+	{
+		std::size_t n = _pool->slab_size;
+		block *s = static_cast<block *>(::operator new(n * sizeof(block)));
+		s->next = _pool->slabs;
+		_pool->slabs = s;
+		for (std::size_t i = n - 1; i > 0; i--)
+		{
+			s[i].next = _pool->free;
+			_pool->free = s + i;
+		}
+		if (n < MAX_SLAB)
+			_pool->slab_size = n * 2;
+	}
+	// links the list from in front of the list to
+	static void prepend(block *&to, block *from)
+	{
+		if (!from)
+			return;
+		block *last = from;
+		while (last->next)
+			last = last->next;
+		last->next = to;
+		to = from;
+	}
+	void release()
+	{
+		if (!_pool || --_pool->refs)
+			return;
+		while (_pool->slabs)
+		{
+			block *s = _pool->slabs;
+			_pool->slabs = s->next;
+			::operator delete(s);
+		}
+		delete _pool;
+	}
+};
+
+namespace ft
+{
+	// a container copy gets a pool of its own rather than sharing one
+	template <class T>
+	struct allocator_copy<pool_allocator<T> >
+	{
+		static pool_allocator<T> select(const pool_allocator<T> &) { return pool_allocator<T>(); }
+	};
+	template <class T>
+	struct allocator_splice<pool_allocator<T> > : true_type
+	{
+		static void splice(pool_allocator<T> &into, pool_allocator<T> &from) { into.splice(from); }
+	};
+}
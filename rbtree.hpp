@@ -1,54 +1,95 @@
 #pragma once
 #include <iostream>
 #include "pair.hpp"
+#include "functional.hpp"
 #include "reverse_iterator.hpp"
 
 namespace ft
 {
 	template <class Key, class Compare = std::less<Key>,
-			  class Allocator = std::allocator<Key> >
+			  class Allocator = std::allocator<Key>,
+			  class KeyOf = ft::identity<Key>, bool Ranked = false>
 	class rbtree;
+
+	// the order statistics read subtree sizes that only a Ranked tree keeps
+	template <bool Ranked>
+	struct requires_ranked_tree;
+	template <>
+	struct requires_ranked_tree<true> {};
 }
 
-template <class Key, class Compare, class Allocator>
+/*
+** Key is the stored value; KeyOf extracts the part Compare orders by, so
+** lookups take just that (or, with a transparent Compare, anything
+** comparable to it). A Ranked tree keeps the size of every subtree, for
+** select(), rank() and O(log n) iterator arithmetic; keeping it costs
+** every insert and erase a walk to the root, so other trees don't.
+*/
+template <class Key, class Compare, class Allocator, class KeyOf, bool Ranked>
 class ft::rbtree
 {
 public:
 	enum nodecolor { BLACK, RED };
-	typedef struct node	{
-		node(Key key) : color(RED),
-						parent(NULL),
-						left(NULL),
-						right(NULL),
-						key(key) {}
-		nodecolor color;
+	struct node;
+	/*
+	** The links of a node. The tree's header is one of these on its own:
+	** parent is the root (whose parent is the header in turn), left and
+	** right the first and last nodes, and its weight 0 tells it apart.
+	*/
+	struct links
+	{
+		links(std::size_t w = 0) : color(RED),
+								   weight(w),
+								   parent(NULL),
+								   left(NULL),
+								   right(NULL) {}
+		// weight (nodes in the subtree rooted here in a Ranked tree, 1 in
+		// any other) shares a word with color
+		nodecolor color : 1;
+		std::size_t weight : sizeof(std::size_t) * 8 - 1;
 		struct node *parent;
 		struct node *left;
 		struct node *right;
+	};
+	typedef struct node : links	{
+		node(const Key &key) : links(1), key(key) {}
+		template <class A, class B>
+		node(const A &a, const B &b) : links(1), key(a, b) {}
 		Key key;
+		// the header after the last node
 		struct node *next()
 		{
 			struct node *n = this;
-			if (right)
+			if (this->right)
 			{
-				n = right;
+				n = this->right;
 				while (n->left)
 					n = n->left;
 			}
 			else
 			{
-				while (n->parent && n == n->parent->right)
-					n = n->parent;
-				n = n->parent;
+				struct node *p = this->parent;
+				while (p && n == p->right)
+				{
+					n = p;
+					p = p->parent;
+				}
+				// a root without a right subtree is header->right: the
+				// climb went through the header, which n now is
+				if (!p || n->right != p)
+					n = p;
 			}
 			return n;
 		}
+		// the last node before the header
 		struct node *prev()
 		{
 			struct node *n = this;
-			if (left)
+			if (!this->weight)
+				return this->right;
+			if (this->left)
 			{
-				n = left;
+				n = this->left;
 				while (n->right)
 					n = n->right;
 			}
@@ -62,6 +103,8 @@ public:
 		}
 	} rbnode;
 	typedef std::size_t size_type;
+	typedef typename KeyOf::type key_type;
+	typedef typename Allocator::template rebind<rbnode>::other node_allocator;
 
 	class const_iterator
 	{
@@ -72,30 +115,22 @@ public:
 		typedef typename Allocator::const_pointer pointer;
 		typedef std::bidirectional_iterator_tag iterator_category;
 
-		const_iterator() : _node(NULL), _rbt(NULL) {}
-		const_iterator(const rbtree<value_type, Compare> &rbt,
-					   typename rbtree<value_type, Compare>::rbnode *node = NULL) : _node(node),
-																					_rbt(&rbt) {}
-		const_iterator(const const_iterator &other) : _node(other._node),
-													  _rbt(other._rbt) {}
+		const_iterator() : _node(NULL) {}
+		// a NULL node is the end
+		const_iterator(const rbtree &rbt, rbnode *node = NULL) : _node(node ? node : rbt.header()) {}
+		const_iterator(const const_iterator &other) : _node(other._node) {}
 		~const_iterator() {}
 
 		const_iterator &operator=(const const_iterator &other)
 		{
 			_node = other._node;
-			_rbt = other._rbt;
 			return *this;
 		}
 		bool operator==(const const_iterator &other) const { return (_node == other._node); }
 		bool operator!=(const const_iterator &other) const { return (_node != other._node); }
-		bool operator<(const const_iterator &other) const
-		{
-			return ((_node && !other._node) || (_comp(_node, other._node)));
-		}
-		bool operator>(const const_iterator &other) const
-		{
-			return ((!_node && other._node) || (_comp(other._node, _node)));
-		}
+		// the comparisons and arithmetic need a Ranked tree
+		bool operator<(const const_iterator &other) const { return (index(_node) < index(other._node)); }
+		bool operator>(const const_iterator &other) const { return (other < *this); }
 		bool operator<=(const const_iterator &other) const
 		{
 			return (!(*this > other));
@@ -107,47 +142,57 @@ public:
 
 		const_iterator &operator++()
 		{
-			_node = _node ? _node->next() : _node;
+			_node = _node->next();
 			return (*this);
 		}
 		const_iterator operator++(int)
 		{
 			const_iterator t(*this);
-			_node = _node ? _node->next() : _node;
+			_node = _node->next();
 			return t;
 		}
 		const_iterator &operator--()
 		{
-			if (_node)
-				_node = _node->prev();
-			else
-				_node = _rbt ? _rbt->mostright() : _node;
+			_node = _node->prev();
 			return (*this);
 		}
 		const_iterator operator--(int)
 		{
 			const_iterator t(*this);
-			if (_node)
-				_node = _node->prev();
-			else
-				_node = _rbt ? _rbt->mostright() : _node;
+			_node = _node->prev();
 			return t;
 		}
 
-		const reference operator*() const { return _node->key; }
-		pointer operator->() const { return &_node->key; }
-		reference operator[](size_type n) const
+		const_iterator &operator+=(difference_type n)
+		{
+			rbnode *h = _node;
+			while (h->weight)
+				h = h->parent;
+			_node = select_in(h->parent, index(_node) + n);
+			if (!_node)
+				_node = h;
+			return (*this);
+		}
+		const_iterator &operator-=(difference_type n) { return (*this += -n); }
+		const_iterator operator+(difference_type n) const
 		{
-			typename rbtree<value_type, Compare>::rbnode *c = _node;
-			while (n-- && c)
-				c = c->next();
-			return c->key;
+			const_iterator t(*this);
+			return (t += n);
+		}
+		const_iterator operator-(difference_type n) const
+		{
+			const_iterator t(*this);
+			return (t -= n);
+		}
+		difference_type operator-(const const_iterator &other) const
+		{
+			return (difference_type)index(_node) - (difference_type)index(other._node);
 		}
-		typename rbtree<value_type, Compare>::rbnode *_node;
 
-	protected:
-		const rbtree<value_type, Compare> *_rbt;
-		Compare _comp;
+		const reference operator*() const { return _node->key; }
+		pointer operator->() const { return &_node->key; }
+		reference operator[](difference_type n) const { return *(*this + n); }
+		rbnode *_node;
 	};
 
 	class iterator : public const_iterator
@@ -163,8 +208,7 @@ public:
 		typedef std::bidirectional_iterator_tag iterator_category;
 
 		iterator() : cit() {}
-		iterator(const rbtree<value_type, Compare> &rbt,
-				 typename rbtree<value_type, Compare>::rbnode *node = NULL) : cit(rbt, node) {}
+		iterator(const rbtree &rbt, rbnode *node = NULL) : cit(rbt, node) {}
 		iterator(const iterator &other) : cit(other) {}
 		~iterator() {}
 
@@ -195,145 +239,336 @@ public:
 			cit::operator--(0);
 			return t;
 		}
+		iterator &operator+=(difference_type n)
+		{
+			cit::operator+=(n);
+			return (*this);
+		}
+		iterator &operator-=(difference_type n)
+		{
+			cit::operator-=(n);
+			return (*this);
+		}
+		iterator operator+(difference_type n) const
+		{
+			iterator t(*this);
+			return (t += n);
+		}
+		iterator operator-(difference_type n) const
+		{
+			iterator t(*this);
+			return (t -= n);
+		}
+		difference_type operator-(const cit &other) const { return cit::operator-(other); }
 
 		reference operator*() const { return cit::_node->key; }
 		pointer operator->() const { return &cit::_node->key; }
-		reference operator[](size_type n) const { return *(cit::base() + n); }
+		reference operator[](difference_type n) const { return *(*this + n); }
 	};
 
-	rbtree() : _root(NULL){}
-	~rbtree(){ free_node(_root); }
-	rbtree(const rbtree &other) { _root = copy_node(other._root); }
+	rbtree() : _root(NULL), _size(0), _background(NULL) { seal(); }
+	// alloc is an Allocator, or the node_allocator of a tree to share it with
+	template <class A>
+	rbtree(const Compare &comp, const A &alloc) : _root(NULL),
+												   _size(0),
+												   _comp(comp),
+												   _node_alloc(alloc),
+												   _background(NULL) { seal(); }
+	~rbtree(){ free_tree(); }
+	rbtree(const rbtree &other) : _root(NULL),
+								  _size(other._size),
+								  _comp(other._comp),
+								  _node_alloc(allocator_copy<node_allocator>::select(other._node_alloc)),
+								  _background(NULL)
+	{
+		_root = copy_node(other._root);
+		reseal();
+	}
 	rbtree &operator=(const rbtree &other)
 	{
 		if(this == &other)
 			return (*this);
-		free_node(_root);
+		clear();
+		_comp = other._comp;
 		_root = copy_node(other._root);
+		_size = other._size;
+		reseal();
 		return (*this);
 	}
-	pair<rbnode*, bool> insert(Key key, rbnode* hint)
+	/*
+	** Where k belongs: .second is 0 when .first already holds it, otherwise
+	** the side of .first (-1 left, 1 right; NULL for an empty tree) a new
+	** node goes on. Callers build the value only once they know it's new.
+	** Keys past either end go straight next to the first or last node,
+	** hinted or not, so ascending or descending input never descends.
+	*/
+	pair<rbnode *, int> locate(const key_type &k, rbnode *hint) const
 	{
 		rbnode *c = _root;
-		if (hint)
+		int dir = 1;
+		if (!_root)
+			return make_pair(c, dir);
+		if (_comp(key_of(_head.right), k))
+			return make_pair(_head.right, 1);
+		if (_comp(k, key_of(_head.left)))
+			return make_pair(_head.left, -1);
+		// the last node and the end are taken care of above
+		if (hint && hint->weight && hint != _head.right)
 		{
 			rbnode *hnxt = hint->next();
-			if(_comp(hint->key,key) && (!hnxt || _comp(key,hnxt->key)))
+			if(_comp(key_of(hint), k) && _comp(k, key_of(hnxt)))
 				c = hint->right ? hnxt : hint;
 		}
 		while (c)
-			if (_comp(key, c->key))
+			if (_comp(k, key_of(c)))
 			{
+				dir = -1;
 				if (!c->left)
 					break;
 				c = c->left;
 			}
-			else if (_comp(c->key, key))
+			else if (_comp(key_of(c), k))
 			{
+				dir = 1;
 				if (!c->right)
 					break;
 				c = c->right;
 			}
 			else
-				return make_pair(c, false);
+				return make_pair(c, 0);
+		return make_pair(c, dir);
+	}
+	rbnode *insert_at(pair<rbnode *, int> pos, const Key &key)
+	{
+		return attach(pos, new_node(key));
+	}
+	// value constructed in place from two arguments, e.g. a map's key and T
+	template <class A, class B>
+	rbnode *insert_at(pair<rbnode *, int> pos, const A &a, const B &b)
+	{
 		rbnode *n = _node_alloc.allocate(1);
-		new (n) rbnode(key);
-		n->parent = c;
-		if (c && _comp(key, c->key))
-			c->left = n;
-		else if (c && _comp(c->key, key))
-			c->right = n;
-		insert_case1(n);
-		_root = get_root(n);
-		return make_pair(n, true);
+		try { new (n) rbnode(a, b); }
+		catch (...) { _node_alloc.deallocate(n, 1); throw; }
+		return attach(pos, n);
 	}
-	void swap(rbtree &other) { std::swap(_root, other._root); }
-	rbnode *mostleft() const
+	pair<rbnode*, bool> insert(const Key &key, rbnode* hint)
 	{
-		rbnode *n = _root;
-		while (n && n->left)
-			n = n->left;
-		return n;
+		pair<rbnode *, int> pos = locate(KeyOf()(key), hint);
+		if (!pos.second)
+			return make_pair(pos.first, false);
+		return make_pair(insert_at(pos, key), true);
 	}
-	rbnode *mostright() const
+	/*
+	** Into an empty tree, the strictly increasing prefix of the range is
+	** linked up as a list and built into a balanced tree in O(n), with no
+	** comparisons beyond the sortedness check and no rotations. The rest
+	** (everything, for a non-empty tree) goes in one by one, hinted with
+	** the previous node so that sorted input still finds its place in O(1).
+	*/
+	template <class InputIt>
+	void insert_range(InputIt first, InputIt last)
 	{
-		rbnode *n = _root;
-		while (n && n->right)
-			n = n->right;
-		return n;
+		rbnode *hint = NULL;
+		if (!_root)
+		{
+			first = build_sorted(first, last);
+			hint = mostright();
+		}
+		for (; first != last; ++first)
+			hint = insert(*first, hint).first;
 	}
+	/*
+	** Set algebra into this (empty) tree: the keys only in a, only in b
+	** and in both are kept as keep has KEEP_LEFT, KEEP_RIGHT, KEEP_BOTH
+	** (shared keys are copied from a). The result is collected in order
+	** and built directly, so there is no per-element rebalancing. Both
+	** inputs are walked in a linear merge, except when the result can
+	** only hold keys of the much smaller input: then each of those is
+	** looked up in the other, O(m log n) instead of O(m + n).
+	*/
+	enum { KEEP_LEFT = 1, KEEP_RIGHT = 2, KEEP_BOTH = 4 };
+	void assign_merge(const rbtree &a, const rbtree &b, int keep)
+	{
+		rbnode *head = NULL, *tail = NULL;
+		size_type n = 0;
+		try
+		{
+			const rbtree &small = a._size < b._size ? a : b;
+			const rbtree &large = a._size < b._size ? b : a;
+			int keep_small = &small == &a ? KEEP_LEFT : KEEP_RIGHT;
+			int keep_large = &small == &a ? KEEP_RIGHT : KEEP_LEFT;
+			if (!(keep & keep_large) && skewed(small._size, large._size))
+				for (rbnode *x = small.mostleft(); x; x = succ(x))
+				{
+					rbnode *y = large.find(key_of(x));
+					if (y && (keep & KEEP_BOTH))
+						append(head, tail, n, &small == &a ? x : y);
+					else if (!y && (keep & keep_small))
+						append(head, tail, n, x);
+				}
+			else
+				for (rbnode *x = a.mostleft(), *y = b.mostleft(); x || y;)
+				{
+					if (!y || (x && _comp(key_of(x), key_of(y))))
+					{
+						if (!y && !(keep & KEEP_LEFT))
+							break;
+						if (keep & KEEP_LEFT)
+							append(head, tail, n, x);
+						x = succ(x);
+					}
+					else if (!x || _comp(key_of(y), key_of(x)))
+					{
+						if (!x && !(keep & KEEP_RIGHT))
+							break;
+						if (keep & KEEP_RIGHT)
+							append(head, tail, n, y);
+						y = succ(y);
+					}
+					else
+					{
+						if (keep & KEEP_BOTH)
+							append(head, tail, n, x);
+						x = succ(x);
+						y = succ(y);
+					}
+				}
+		}
+		catch (...)
+		{
+			free_list(head);
+			throw;
+		}
+		build_from_list(head, n);
+	}
+	void swap(rbtree &other)
+	{
+		std::swap(_root, other._root);
+		std::swap(_size, other._size);
+		std::swap(_comp, other._comp);
+		std::swap(_node_alloc, other._node_alloc);
+		std::swap(_head.left, other._head.left);
+		std::swap(_head.right, other._head.right);
+		seal();
+		other.seal();
+	}
+	node_allocator get_allocator() const { return _node_alloc; }
+	// first and last nodes, NULL for an empty tree
+	rbnode *mostleft() const { return _root ? _head.left : NULL; }
+	rbnode *mostright() const { return _root ? _head.right : NULL; }
 	const rbnode *getRoot() const { return _root; }
 	rbnode *getRoot() { return _root; }
 	void erase(const_iterator pos)
 	{
-		if (pos._node)
+		if (pos._node != header())
 			delnode(pos._node);
 	}
 	void delnode(rbnode *n)
 	{
-		if(n->left && n->right)
+		unlink(n);
+		n->~rbnode();
+		_node_alloc.deallocate(n, 1);
+	}
+	/*
+	** Splitting and joining whole trees in O(log n), e.g. to cut out a
+	** key range. split() moves the keys not less than key into other,
+	** which must be empty and ends up sharing this tree's allocator.
+	** join() appends other, whose keys must all be greater than ours,
+	** leaving it empty; nodes are relinked, not copied, unless the two
+	** allocators differ.
+	*/
+	template <class K>
+	void split(const K &key, rbtree &other)
+	{
+		rbnode *l, *r;
+		size_type hl, hr;
+		open();
+		split_nodes(_root, black_height(_root), key, l, hl, r, hr);
+		size_type nl = weight(l), nr = weight(r);
+		if (!Ranked)
+			count_split(l, r, _size, nl, nr);
+		_root = l;
+		_size = nl;
+		reseal();
+		other._root = r;
+		other._size = nr;
+		other._node_alloc = _node_alloc;
+		other.reseal();
+	}
+	void join(rbtree &other)
+	{
+		if (!other._root)
+			return;
+		if (!_root)
 		{
-			rbnode *p = n->parent;
-			rbnode *nl = n->left;
-			rbnode *nr = n->right;
-			rbnode *s = n->next();
-			rbnode *sp = s->parent;
-			rbnode *sr = s->right;
-			if(p && n==p->left)
-				p->left = s;
-			else if(p && n==p->right)
-				p->right = s;
-			s->parent = p;
-			s->left = nl;
-			if(nl)
-				nl->parent = s;
-			if(s==nr)
-			{
-				s->right = n;
-				n->parent = s;
-			}else{
-				s->right = nr;
-				nr->parent = s;
-				sp->left = n;
-				n->parent = sp;
-			}
-			n->right = sr;
-			if(sr)
-				sr->parent = n;
-			n->left = NULL;
-			_root = get_root(s);
+			swap(other);
+			return;
 		}
-		delete_one_child(n);
+		if (_node_alloc != other._node_alloc)
+		{
+			insert_range(other.begin(), other.end());
+			other.clear();
+			return;
+		}
+		size_type n = _size + other._size;
+		rbnode *k = other.mostleft();
+		other.unlink(k);
+		size_type h;
+		open();
+		other.open();
+		_root = join_nodes(_root, black_height(_root), k, other._root, black_height(other._root), h);
+		_size = n;
+		reseal();
+		other._root = NULL;
+		other._size = 0;
+		other.seal();
 	}
-	rbnode *find(Key key) const
+	template <class K>
+	rbnode *find(const K &key) const
 	{
 		rbnode *n = _root;
 		while (n)
-			if (_comp(key, n->key))
+			if (_comp(key, key_of(n)))
 				n = n->left;
-			else if (_comp(n->key, key))
+			else if (_comp(key_of(n), key))
 				n = n->right;
 			else
 				break;
 		return n;
 	}
 	bool empty() const { return _root == NULL; }
-	std::size_t size() const { return size(_root); }
+	std::size_t size() const { return _size; }
 	void clear()
 	{
-		free_node(_root);
+		free_tree();
 		_root = NULL;
+		_size = 0;
+		seal();
 	}
-	rbnode *lower_bound(Key key) const
+	/*
+	** Copying and freeing big trees on several threads (0: one per core).
+	** The nodes above a cut a few levels down are done by the caller, the
+	** subtrees below it are jobs for run_parallel, stitched back under
+	** their copied parents. The allocator has to take several threads at
+	** once (is_concurrent_allocator); otherwise, and for small trees, these
+	** are the plain serial walks. Defined in rbtree_parallel.hpp, so that
+	** only the code using them has to include it and link with -pthread.
+	*/
+	void assign_parallel(const rbtree &other, unsigned threads);
+	void clear_parallel(unsigned threads);
+	// from now on clear(), assignment and the destructor leave the freeing to the background thread
+	void set_background_free(bool on);
+	template <class K>
+	rbnode *lower_bound(const K &key) const
 	{
 		rbnode *n = _root, *p = NULL;
 		while (n)
-			if (_comp(key, n->key))
+			if (_comp(key, key_of(n)))
 			{
 				p = n;
 				n = n->left;
 			}
-			else if (_comp(n->key, key))
+			else if (_comp(key_of(n), key))
 				n = n->right;
 			else {
 				p = n;
@@ -341,11 +576,61 @@ public:
 			}
 		return p;
 	}
-	rbnode *upper_bound(Key key) const
+	// k-th smallest node, NULL when k is past the end
+	rbnode *select(size_type k) const { return select_in(_root, k); }
+	static rbnode *select_in(rbnode *n, size_type k)
+	{
+		(void)sizeof(requires_ranked_tree<Ranked>);
+		while (n)
+		{
+			size_type l = weight(n->left);
+			if (k < l)
+				n = n->left;
+			else if (k > l)
+			{
+				k -= l + 1;
+				n = n->right;
+			}
+			else
+				break;
+		}
+		return n;
+	}
+	// number of keys less than key
+	template <class K>
+	size_type rank(const K &key) const
+	{
+		(void)sizeof(requires_ranked_tree<Ranked>);
+		rbnode *n = _root;
+		size_type r = 0;
+		while (n)
+			if (_comp(key_of(n), key))
+			{
+				r += weight(n->left) + 1;
+				n = n->right;
+			}
+			else
+				n = n->left;
+		return r;
+	}
+	// position of n in order, size() for the end (header) node
+	static size_type index(const rbnode *n)
+	{
+		(void)sizeof(requires_ranked_tree<Ranked>);
+		if (!n->weight)
+			return weight(n->parent);
+		size_type r = weight(n->left);
+		for (; n->parent->weight; n = n->parent)
+			if (n == n->parent->right)
+				r += weight(n->parent->left) + 1;
+		return r;
+	}
+	template <class K>
+	rbnode *upper_bound(const K &key) const
 	{
 		rbnode *n = _root, *p = NULL;
 		while (n)
-			if (_comp(key, n->key))
+			if (_comp(key, key_of(n)))
 			{
 				p = n;
 				n = n->left;
@@ -355,8 +640,8 @@ public:
 		return p;
 	}
 	std::size_t max_size() const { return _node_alloc.max_size(); }
-	iterator begin() { return iterator(*this, mostleft()); }
-	const_iterator begin() const { return const_iterator(*this, mostleft()); }
+	iterator begin() { return iterator(*this, _head.left); }
+	const_iterator begin() const { return const_iterator(*this, _head.left); }
 	iterator end() { return iterator(*this); }
 	const_iterator end() const { return const_iterator(*this); }
 	typedef typename ft::reverse_iterator<iterator> reverse_iterator;
@@ -368,23 +653,188 @@ public:
 
 private:
 	rbnode *_root;
+	std::size_t _size;
 	Compare _comp;
-	typename Allocator::template rebind<rbnode>::other _node_alloc;
+	node_allocator _node_alloc;
+	links _head;
+	// queues fn(arg) for the background thread (run_background), set by set_background_free()
+	bool (*_background)(void (*)(void *), void *);
 
-	rbnode *copy_node(rbnode *n)
+	rbnode *header() const { return static_cast<rbnode *>(const_cast<links *>(&_head)); }
+	/*
+	** The rebalancing code takes a NULL parent for the root, so the header
+	** is only linked in between operations: open() takes it out, seal()
+	** puts it back once _root, _head.left and _head.right are right again,
+	** reseal() after a bulk change finds the first and last nodes anew.
+	*/
+	void open()
+	{
+		if (_root)
+			_root->parent = NULL;
+	}
+	void seal()
+	{
+		_head.parent = _root;
+		if (_root)
+			_root->parent = header();
+		else
+			_head.left = _head.right = header();
+	}
+	void reseal()
+	{
+		for (_head.left = _root; _root && _head.left->left;)
+			_head.left = _head.left->left;
+		for (_head.right = _root; _root && _head.right->right;)
+			_head.right = _head.right->right;
+		seal();
+	}
+	// next node in order, NULL after the last
+	static rbnode *succ(rbnode *n)
+	{
+		n = n->next();
+		return n->weight ? n : NULL;
+	}
+	rbnode *attach(pair<rbnode *, int> pos, rbnode *n)
+	{
+		rbnode *c = pos.first;
+		open();
+		if (!c)
+			_root = _head.left = _head.right = n;
+		else if (pos.second < 0 && c == _head.left)
+			_head.left = n;
+		else if (pos.second > 0 && c == _head.right)
+			_head.right = n;
+		n->parent = c;
+		if (c && pos.second < 0)
+			c->left = n;
+		else if (c)
+			c->right = n;
+		for (; Ranked && c; c = c->parent)
+			++c->weight;
+		// rotations at the root move _root themselves
+		insert_case1(n);
+		++_size;
+		seal();
+		return n;
+	}
+	// consumes the strictly increasing prefix of [first, last) as the tree
+	template <class InputIt>
+	InputIt build_sorted(InputIt first, InputIt last)
+	{
+		rbnode *head = NULL, *tail = NULL;
+		size_type n = 0;
+		try
+		{
+			for (; first != last; ++first, ++n)
+			{
+				if (tail && !_comp(key_of(tail), KeyOf()(*first)))
+					break;
+				rbnode *c = new_node(*first);
+				(tail ? tail->right : head) = c;
+				tail = c;
+			}
+		}
+		catch (...)
+		{
+			free_list(head);
+			throw;
+		}
+		build_from_list(head, n);
+		return first;
+	}
+	// probing m keys into a tree of n beats walking both
+	static bool skewed(size_type m, size_type n)
+	{
+		size_type log = 1;
+		while (n >> log)
+			++log;
+		return m * log < n;
+	}
+	void append(rbnode *&head, rbnode *&tail, size_type &n, const rbnode *from)
+	{
+		rbnode *c = new_node(from->key);
+		(tail ? tail->right : head) = c;
+		tail = c;
+		++n;
+	}
+	rbnode *new_node(const Key &key) { return new_node(key, _node_alloc); }
+	static rbnode *new_node(const Key &key, node_allocator &alloc)
+	{
+		rbnode *n = alloc.allocate(1);
+		try { new (n) rbnode(key); }
+		catch (...) { alloc.deallocate(n, 1); throw; }
+		return n;
+	}
+	// frees a list of nodes linked through right
+	void free_list(rbnode *head)
+	{
+		while (head)
+		{
+			rbnode *c = head;
+			head = head->right;
+			c->~rbnode();
+			_node_alloc.deallocate(c, 1);
+		}
+	}
+	// makes the n nodes of the list (in order, linked through right) this tree
+	void build_from_list(rbnode *head, size_type n)
+	{
+		size_type full = 0;
+		while ((size_type(2) << full) <= n + 1)
+			++full;
+		_root = build(head, n, 0, full);
+		if (_root)
+			_root->parent = NULL;
+		_size = n;
+		reseal();
+	}
+	/*
+	** Balanced tree over the next n nodes of the list (linked through
+	** right). Levels above red_depth are complete and black; the partial
+	** bottom level, if any, is red, so every path has the same black count.
+	*/
+	static rbnode *build(rbnode *&list, size_type n, size_type depth, size_type red_depth)
 	{
 		if (!n)
-			return n;
-		rbnode *r = _node_alloc.allocate(1);
-		new (r) rbnode(n->key);
+			return NULL;
+		rbnode *l = build(list, (n - 1) / 2, depth + 1, red_depth);
+		rbnode *m = list;
+		list = list->right;
+		m->left = l;
+		if (l)
+			l->parent = m;
+		m->right = build(list, n / 2, depth + 1, red_depth);
+		if (m->right)
+			m->right->parent = m;
+		m->color = depth == red_depth ? RED : BLACK;
+		if (Ranked)
+			m->weight = n;
+		return m;
+	}
+	rbnode *copy_node(rbnode *n) { return copy_node(n, _node_alloc); }
+	static rbnode *copy_node(const rbnode *n, node_allocator &alloc)
+	{
+		if (!n)
+			return NULL;
+		rbnode *r = new_node(n->key, alloc);
 		r->parent = NULL;
-		r->left = copy_node(n->left);
-		if(r->left)
-			r->left->parent = r;
-		r->right = copy_node(n->right);
-		if (r->right)
-			r->right->parent = r;
+		// a throw frees what has been copied of this subtree so far
+		try
+		{
+			r->left = copy_node(n->left, alloc);
+			if(r->left)
+				r->left->parent = r;
+			r->right = copy_node(n->right, alloc);
+			if (r->right)
+				r->right->parent = r;
+		}
+		catch (...)
+		{
+			free_node(r, alloc);
+			throw;
+		}
 		r->color = n->color;
+		r->weight = n->weight;
 		return r;
 	}
 	rbnode *grandparent(rbnode *n)
@@ -421,6 +871,7 @@ private:
 			pivot->left->parent = n;
 		n->parent = pivot;
 		pivot->left = n;
+		reweigh(pivot, n);
 	}
 	void rotate_right(rbnode *n)
 	{
@@ -439,6 +890,7 @@ private:
 			pivot->right->parent = n;
 		n->parent = pivot;
 		pivot->right = n;
+		reweigh(pivot, n);
 	}
 	void insert_case5(rbnode *n)
 	{
@@ -546,15 +998,15 @@ private:
 		if (s->color == BLACK)
 		{	
 			if ((n == n->parent->left) &&
-				(s->right->color == BLACK) &&
-				(s->left->color == RED))
+				(!s->right || s->right->color == BLACK) &&
+				(s->left && s->left->color == RED))
 			{
 				s->color = RED;
 				s->left->color = BLACK;
 				rotate_right(s);
 			} else if ((n == n->parent->right) &&
-					  (s->left->color == BLACK) &&
-					  (s->right->color == RED))
+					  (!s->left || s->left->color == BLACK) &&
+					  (s->right && s->right->color == RED))
 			{
 				s->color = RED;
 				s->right->color = BLACK;
@@ -612,41 +1064,358 @@ private:
 		if (n->parent != NULL)
 			delete_case2(n);
 	}
+	// takes n out of the tree without freeing it
+	void unlink(rbnode *n)
+	{
+		if (n == _head.left)
+			_head.left = n->next();
+		if (n == _head.right)
+			_head.right = n->prev();
+		open();
+		if(n->left && n->right)
+		{
+			rbnode *p = n->parent;
+			rbnode *nl = n->left;
+			rbnode *nr = n->right;
+			rbnode *s = n->next();
+			rbnode *sp = s->parent;
+			rbnode *sr = s->right;
+			if(p && n==p->left)
+				p->left = s;
+			else if(p && n==p->right)
+				p->right = s;
+			s->parent = p;
+			s->left = nl;
+			if(nl)
+				nl->parent = s;
+			if(s==nr)
+			{
+				s->right = n;
+				n->parent = s;
+			}else{
+				s->right = nr;
+				nr->parent = s;
+				sp->left = n;
+				n->parent = sp;
+			}
+			n->right = sr;
+			if(sr)
+				sr->parent = n;
+			n->left = NULL;
+			nodecolor c = n->color;
+			n->color = s->color;
+			s->color = c;
+			if (Ranked)
+			{
+				std::size_t w = n->weight;
+				n->weight = s->weight;
+				s->weight = w;
+			}
+			if (!p)
+				_root = s;
+		}
+		delete_one_child(n);
+		seal();
+	}
 	void delete_one_child(rbnode *n)
 	{
 		rbnode *child = n->right ? n->right : n->left;
-		replace_node(n, child);
-		// std::cout << "----------- replace_node ----------" << std::endl;
-		// print_tree(_root, 0);
-		if (n->color == BLACK && child)
+		// a black node with a single child always has a red one; a black
+		// leaf is rebalanced while still linked, standing in for its NULL
+		if (n->color == BLACK)
 		{
-			if (child->color == RED)
+			if (child)
 				child->color = BLACK;
 			else
-				delete_case1(child);
+				delete_case1(n);
 		}
-		n->~rbnode();
-		_node_alloc.deallocate(n, 1);
+		for (rbnode *p = n->parent; Ranked && p; p = p->parent)
+			--p->weight;
+		replace_node(n, child);
+		// std::cout << "----------- replace_node ----------" << std::endl;
+		// print_tree(_root, 0);
+		--_size;
 	}
+	static size_type weight(const rbnode *n) { return n ? n->weight : 0; }
+	// after a rotation that made pivot n's parent
+	static void reweigh(rbnode *pivot, rbnode *n)
+	{
+		if (!Ranked)
+			return;
+		pivot->weight = n->weight;
+		n->weight = weight(n->left) + weight(n->right) + 1;
+	}
+	static const key_type &key_of(const rbnode *n) { return KeyOf()(n->key); }
 	rbnode *get_root(rbnode *n)
 	{
 		while (n && n->parent)
 			n = n->parent;
 		return n;
 	}
-	std::size_t size(rbnode *n) const
+	// black nodes on every path from n down to a leaf, n included
+	static size_type black_height(const rbnode *n)
+	{
+		size_type h = 0;
+		for (; n; n = n->left)
+			h += n->color == BLACK;
+		return h;
+	}
+	void link(rbnode *n, rbnode *l, rbnode *r)
+	{
+		n->left = l;
+		if (l)
+			l->parent = n;
+		n->right = r;
+		if (r)
+			r->parent = n;
+		if (Ranked)
+			n->weight = weight(l) + weight(r) + 1;
+	}
+	/*
+	** Sizes nl and nr of the detached trees l and r, n nodes in all, for a
+	** tree without weights: both are walked in step until one runs out, so
+	** only the smaller is counted.
+	*/
+	static void count_split(rbnode *l, rbnode *r, size_type n, size_type &nl, size_type &nr)
+	{
+		while (l && l->left)
+			l = l->left;
+		while (r && r->left)
+			r = r->left;
+		size_type k = 0;
+		for (; l && r; l = l->next(), r = r->next())
+			++k;
+		nl = l ? n - k : k;
+		nr = n - nl;
+	}
+	// makes the subtree at n a tree of its own (black root), adjusting its height h
+	static rbnode *detach(rbnode *n, size_type &h)
 	{
 		if (!n)
-			return 0;
-		return size(n->left) + 1 + size(n->right);
+			return n;
+		n->parent = NULL;
+		if (n->color == RED)
+		{
+			n->color = BLACK;
+			++h;
+		}
+		return n;
 	}
-	void free_node(rbnode *n)
+	/*
+	** Joins two detached trees of black heights hl and hr around k (all of
+	** l < k < all of r); h gets the result's. k goes in red on the taller
+	** tree's spine, above the first black node as high as the shorter tree,
+	** and red-red violations are then fixed upwards as after an insert.
+	** The rotations may point _root anywhere: callers set it afterwards.
+	*/
+	rbnode *join_nodes(rbnode *l, size_type hl, rbnode *k, rbnode *r, size_type hr, size_type &h)
+	{
+		if (hl == hr)
+		{
+			k->parent = NULL;
+			k->color = BLACK;
+			link(k, l, r);
+			h = hl + 1;
+			return k;
+		}
+		bool down_right = hl > hr;
+		rbnode *c = down_right ? l : r, *p = NULL;
+		size_type ch = down_right ? hl : hr, target = down_right ? hr : hl;
+		while (c && (c->color == RED || ch != target))
+		{
+			ch -= c->color == BLACK;
+			p = c;
+			c = down_right ? c->right : c->left;
+		}
+		k->color = RED;
+		k->parent = p;
+		if (down_right)
+		{
+			link(k, c, r);
+			p->right = k;
+		}
+		else
+		{
+			link(k, l, c);
+			p->left = k;
+		}
+		size_type added = weight(down_right ? r : l) + 1;
+		for (rbnode *a = p; Ranked && a; a = a->parent)
+			a->weight += added;
+		h = down_right ? hl : hr;
+		for (rbnode *n = k; n;)
+		{
+			p = n->parent;
+			if (!p)
+			{
+				if (n->color == RED)
+				{
+					n->color = BLACK;
+					++h;
+				}
+				break;
+			}
+			if (p->color == BLACK)
+				break;
+			rbnode *u = uncle(n);
+			if (u && u->color == RED)
+			{
+				p->color = BLACK;
+				u->color = BLACK;
+				n = grandparent(n);
+				n->color = RED;
+				continue;
+			}
+			insert_case4(n);
+			break;
+		}
+		return get_root(k);
+	}
+	// splits the detached tree t (black height ht) into keys < key and the rest
+	template <class K>
+	void split_nodes(rbnode *t, size_type ht, const K &key, rbnode *&l, size_type &hl,
+					 rbnode *&r, size_type &hr)
+	{
+		if (!t)
+		{
+			l = r = NULL;
+			hl = hr = 0;
+			return;
+		}
+		size_type ha = ht - 1, hb = ht - 1, hm;
+		rbnode *a = detach(t->left, ha), *b = detach(t->right, hb), *m;
+		if (_comp(key_of(t), key))
+		{
+			split_nodes(b, hb, key, m, hm, r, hr);
+			l = join_nodes(a, ha, t, m, hm, hl);
+		}
+		else
+		{
+			split_nodes(a, ha, key, l, hl, m, hm);
+			r = join_nodes(m, hm, t, b, hb, hr);
+		}
+	}
+	// nothing to run or give back per node for trivial keys in an arena
+	void free_tree()
+	{
+		if (is_monotonic_allocator<node_allocator>::value &&
+			is_trivially_destructible<Key>::value)
+			return;
+		if (_background && _root && is_concurrent_allocator<node_allocator>::value)
+		{
+			teardown *t = new teardown(_node_alloc, _root);
+			if (_background(teardown::run, t))
+				return;
+			delete t;
+		}
+		free_node(_root);
+	}
+	// a tree being freed on the background thread, with its own copy of the allocator
+	struct teardown
+	{
+		teardown(const node_allocator &a, rbnode *r) : alloc(a), root(r) {}
+		node_allocator alloc;
+		rbnode *root;
+
+		static void run(void *p)
+		{
+			teardown *t = static_cast<teardown *>(p);
+			free_node(t->root, t->alloc);
+			delete t;
+		}
+	};
+
+	// copies the subtree at from, whose copy goes to *to under parent (rbtree_parallel.hpp)
+	struct copy_job;
+	struct free_job
+	{
+		rbtree *tree;
+		rbnode *root;
+
+		void operator()() { tree->free_node(root); }
+	};
+	enum { PARALLEL_MIN = 1 << 15 };
+	/*
+	** threads: as resolved by the caller, never 0. Freeing needs an
+	** allocator the threads can share; a copy may instead give each thread
+	** an allocator of its own, whose memory the tree's takes over after.
+	*/
+	bool parallel(size_type n, unsigned threads, bool copy) const
+	{
+		return threads > 1 && n >= PARALLEL_MIN &&
+			   (is_concurrent_allocator<node_allocator>::value ||
+				(copy && allocator_splice<node_allocator>::value));
+	}
+	// deep enough for a few subtrees per thread, so that uneven ones even out
+	static size_type cut_depth(unsigned threads)
+	{
+		size_type d = 0;
+		while ((size_type(1) << d) < size_type(threads) * 8)
+			++d;
+		return d;
+	}
+	// copies the nodes above depth, leaving the subtrees at depth to jobs
+	template <class Jobs>
+	rbnode *copy_top(const rbnode *n, rbnode *parent, size_type depth, Jobs &jobs)
+	{
+		if (!n)
+			return NULL;
+		rbnode *r = new_node(n->key);
+		r->parent = parent;
+		r->color = n->color;
+		r->weight = n->weight;
+		// the jobs haven't run, so a throw leaves only nodes copied here to free
+		try
+		{
+			if (depth == 1)
+			{
+				copy_job l = {n->left, &r->left, r, NULL, node_allocator()};
+				copy_job g = {n->right, &r->right, r, NULL, node_allocator()};
+				if (n->left)
+					jobs.push_back(l);
+				if (n->right)
+					jobs.push_back(g);
+			}
+			else
+			{
+				r->left = copy_top(n->left, r, depth - 1, jobs);
+				r->right = copy_top(n->right, r, depth - 1, jobs);
+			}
+		}
+		catch (...)
+		{
+			free_node(r);
+			throw;
+		}
+		return r;
+	}
+	// frees the nodes above depth, leaving the subtrees at depth to jobs
+	template <class Jobs>
+	void free_top(rbnode *n, size_type depth, Jobs &jobs)
 	{
 		if (!n)
 			return;
-		free_node(n->left);
-		free_node(n->right);
+		if (!depth)
+		{
+			free_job j = {this, n};
+			jobs.push_back(j);
+			return;
+		}
+		free_top(n->left, depth - 1, jobs);
+		free_top(n->right, depth - 1, jobs);
 		n->~rbnode();
 		_node_alloc.deallocate(n, 1);
 	}
+	void free_node(rbnode *n) { free_node(n, _node_alloc); }
+	static void free_node(rbnode *n, node_allocator &alloc)
+	{
+		while (n)
+		{
+			free_node(n->left, alloc);
+			rbnode *r = n->right;
+			n->~rbnode();
+			alloc.deallocate(n, 1);
+			n = r;
+		}
+	}
 };
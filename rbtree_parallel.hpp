@@ -0,0 +1,97 @@
+#pragma once
+#include "rbtree.hpp"
+#include "vector.hpp"
+#include "parallel.hpp"
+
+/*
+** The threaded members of rbtree, and so of map and set: assign_parallel(),
+** clear_parallel() and set_background_free(). They run on pthreads, so a
+** program that includes this header links with -pthread; one that doesn't
+** gets plain serial trees that don't need it. Under an allocator that is
+** neither concurrent nor spliceable (see traits.hpp) all three fall back to
+** the serial walks.
+*/
+
+template <class Key, class Compare, class Allocator, class KeyOf, bool Ranked>
+struct ft::rbtree<Key, Compare, Allocator, KeyOf, Ranked>::copy_job
+{
+	const rbnode *from;
+	rbnode **to;
+	rbnode *parent;
+	job_error *error;
+	node_allocator alloc;	// the tree's if threads may share it, else a fresh one the tree's splices in after
+
+	// copy_node() frees its partial copy on a throw, leaving *to NULL
+	void operator()()
+	{
+		try { *to = copy_node(from, alloc); }
+		catch (...) { error->catch_current(); }
+	}
+};
+
+template <class Key, class Compare, class Allocator, class KeyOf, bool Ranked>
+void ft::rbtree<Key, Compare, Allocator, KeyOf, Ranked>::assign_parallel(const rbtree &other, unsigned threads)
+{
+	if (this == &other)
+		return;
+	if (!threads)
+		threads = hardware_threads();
+	if (!parallel(other._size, threads, true))
+	{
+		*this = other;
+		return;
+	}
+	clear_parallel(threads);
+	_comp = other._comp;
+	ft::vector<copy_job> jobs;
+	job_error error;
+	// copy_top() frees its own nodes on a throw
+	_root = copy_top(other._root, NULL, cut_depth(threads), jobs);
+	for (std::size_t i = 0; i < jobs.size(); i++)
+	{
+		jobs[i].error = &error;
+		jobs[i].alloc = is_concurrent_allocator<node_allocator>::value ? _node_alloc
+																	 : allocator_copy<node_allocator>::select(_node_alloc);
+	}
+	run_parallel(jobs.empty() ? NULL : &jobs[0], jobs.size(), threads);
+	for (std::size_t i = 0; i < jobs.size(); i++)
+	{
+		allocator_splice<node_allocator>::splice(_node_alloc, jobs[i].alloc);
+		if (*jobs[i].to)
+			(*jobs[i].to)->parent = jobs[i].parent;
+	}
+	if (error.thrown)
+	{
+		clear();
+		error.rethrow();
+		// what Key's copy threw didn't make it here: copy again on this thread, where it throws as it would have
+		*this = other;
+		return;
+	}
+	_size = other._size;
+	reseal();
+}
+
+template <class Key, class Compare, class Allocator, class KeyOf, bool Ranked>
+void ft::rbtree<Key, Compare, Allocator, KeyOf, Ranked>::clear_parallel(unsigned threads)
+{
+	if (!threads)
+		threads = hardware_threads();
+	if (!parallel(_size, threads, false) || _background)
+	{
+		clear();
+		return;
+	}
+	ft::vector<free_job> jobs;
+	free_top(_root, cut_depth(threads), jobs);
+	run_parallel(jobs.empty() ? NULL : &jobs[0], jobs.size(), threads);
+	_root = NULL;
+	_size = 0;
+	seal();
+}
+
+template <class Key, class Compare, class Allocator, class KeyOf, bool Ranked>
+void ft::rbtree<Key, Compare, Allocator, KeyOf, Ranked>::set_background_free(bool on)
+{
+	_background = on ? run_background : NULL;
+}
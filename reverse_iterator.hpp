@@ -62,11 +62,21 @@ public:
 		_iter += n;
 		return *this;
 	}
-	pointer operator->() const { return &(operator*()); }
+	pointer operator->() const
+	{
+		Iter t = _iter;
+		return arrow(--t);
+	}
 	reference operator[](difference_type n) const { return *(*this + n); }
 
 private:
 	Iter _iter;
+
+	// through the iterator's own operator->, which also works for proxy references
+	template <typename I>
+	static typename I::pointer arrow(const I &i) { return i.operator->(); }
+	template <typename T>
+	static T *arrow(T *p) { return p; }
 };
 
 template <typename Iter>
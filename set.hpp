@@ -1,14 +1,17 @@
 #pragma once
 #include "rbtree.hpp"
+#include "pool_allocator.hpp"
 
 namespace ft
 {
 	template <class Key, class Compare = std::less<Key>,
-			  class Allocator = std::allocator<Key> >
+			  class Allocator = ft::pool_allocator<Key>, bool Ranked = false>
 	class set;
 }
 
-template <class Key, class Compare, class Allocator>
+// Ranked keeps the subtree sizes nth(), rank(), count_range() and O(log n)
+// iterator arithmetic need, at a walk to the root on every insert and erase
+template <class Key, class Compare, class Allocator, bool Ranked>
 class ft::set
 {
 public:
@@ -24,10 +27,14 @@ public:
 	typedef typename Allocator::pointer pointer;
 	typedef typename Allocator::const_pointer const_pointer;
 
-	typedef typename rbtree<value_type, value_compare>::const_iterator iterator;
-	typedef typename rbtree<value_type, value_compare>::const_iterator const_iterator;
-	typedef typename rbtree<value_type, value_compare>::const_reverse_iterator reverse_iterator;
-	typedef typename rbtree<value_type, value_compare>::const_reverse_iterator const_reverse_iterator;
+private:
+	typedef rbtree<value_type, value_compare, Allocator, ft::identity<value_type>, Ranked> tree;
+
+public:
+	typedef typename tree::const_iterator iterator;
+	typedef typename tree::const_iterator const_iterator;
+	typedef typename tree::const_reverse_iterator reverse_iterator;
+	typedef typename tree::const_reverse_iterator const_reverse_iterator;
 
 	iterator begin() { return _rbt.begin(); }
 	const_iterator begin() const { return _rbt.begin(); }
@@ -40,64 +47,80 @@ public:
 
 	set(){}
 	explicit set(const Compare &comp,
-				 const Allocator &alloc = Allocator()) : _alloc(alloc),
-														 _comp(comp) {}
+				 const Allocator &alloc = Allocator()) : _comp(comp),
+														 _rbt(comp, alloc) {}
 	template <class InputIt>
 	set(InputIt first, InputIt last,
 		const Compare &comp = Compare(),
-		const Allocator &alloc = Allocator()) : _alloc(alloc),
-												_comp(comp)
+		const Allocator &alloc = Allocator()) : _comp(comp),
+												_rbt(comp, alloc)
 	{
-		while (first != last)
-		{
-			insert(*first);
-			++first;
-		}
+		_rbt.insert_range(first, last);
 	}
-	set(const set &other) : _rbt(other._rbt) {}
+	set(const set &other) : _comp(other._comp),
+							_rbt(other._rbt) {}
 	~set(){}
 	set &operator=(const set &other)
 	{
 		if (this == &other)
 			return (*this);
+		_comp = other._comp;
 		_rbt = other._rbt;
 		return (*this);
 	}
-	allocator_type get_allocator() const { return _alloc; }
+	// the tree's own, i.e. the one its nodes come from, rebound
+	allocator_type get_allocator() const { return allocator_type(_rbt.get_allocator()); }
 
 	bool empty() const { return _rbt.empty(); }
 	size_type size() const { return _rbt.size(); }
 	size_type max_size() const { return _rbt.max_size(); }
 	void clear() { _rbt.clear(); }
+	/*
+	** For huge trees; 0 threads: one per core. These three need
+	** rbtree_parallel.hpp included, and -pthread. assign_parallel() takes
+	** std::allocator or pool_allocator (each thread copies into a pool of its
+	** own). clear_parallel() and the background free need an allocator the
+	** threads can share, i.e. std::allocator; with any other, the default
+	** pool_allocator included, they are a plain clear(). The copy constructor
+	** stays serial.
+	*/
+	void assign_parallel(const set &other, unsigned threads = 0)
+	{
+		_comp = other._comp;
+		_rbt.assign_parallel(other._rbt, threads);
+	}
+	void clear_parallel(unsigned threads = 0) { _rbt.clear_parallel(threads); }
+	// clear(), assignment and the destructor return at once, the nodes being queued for one background thread
+	void set_background_free(bool on) { _rbt.set_background_free(on); }
 	pair<iterator, bool> insert(const value_type &value)
 	{
-		pair<typename rbtree<value_type, value_compare>::rbnode *, bool> p = _rbt.insert(value, NULL);
+		pair<typename tree::rbnode *, bool> p = _rbt.insert(value, NULL);
 		return make_pair(iterator(_rbt, p.first), p.second);
 	}
 	iterator insert(iterator hint, const value_type &value)
 	{
-		pair<typename rbtree<value_type, value_compare>::rbnode *, bool> p = _rbt.insert(value, hint._node);
+		pair<typename tree::rbnode *, bool> p = _rbt.insert(value, hint._node);
 		return iterator(_rbt, p.first);
 	}
 	template <class InputIt>
 	void insert(InputIt first, InputIt last)
 	{
-		while (first != last)
-		{
-			insert(*first);
-			++first;
-		}
+		_rbt.insert_range(first, last);
 	}
 	void erase(iterator pos) { _rbt.erase(pos); }
+	// the range is cut out in O(log n), then its nodes are freed
 	void erase(iterator first, iterator last)
 	{
-		while (first != last)
+		if (first == last)
+			return;
+		if (last != end())
 		{
-			iterator t = first;
-			++t;
-			erase(first);
-			first = t;
+			extract_range(*first, *last);
+			return;
 		}
+		// the tail's nodes are this tree's, so is the allocator they go back to
+		tree tail(_comp, _rbt.get_allocator());
+		_rbt.split(*first, tail);
 	}
 	size_type erase(const key_type &key)
 	{
@@ -107,7 +130,11 @@ public:
 		erase(pos);
 		return 1;
 	}
-	void swap(set &other) { _rbt.swap(other._rbt); }
+	void swap(set &other)
+	{
+		std::swap(_comp, other._comp);
+		_rbt.swap(other._rbt);
+	}
 
 	size_type count(const Key &key) const { return (!!_rbt.find(key)); }
 	iterator find(const Key &key) { return iterator(_rbt, _rbt.find(key)); }
@@ -127,23 +154,108 @@ public:
 	iterator upper_bound(const Key &key) { return iterator(_rbt, _rbt.upper_bound(key)); }
 	const_iterator upper_bound(const Key &key) const { return const_iterator(_rbt, _rbt.upper_bound(key)); }
 
-	key_compare key_comp() const { return key_compare(); }
-	value_compare value_comp() const { return value_compare(); }
+	// heterogeneous lookup, for a Compare that defines is_transparent
+	template <class K>
+	typename enable_if_transparent<Compare, K, size_type>::type
+	count(const K &key) const { return (!!_rbt.find(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	find(const K &key) { return iterator(_rbt, _rbt.find(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, const_iterator>::type
+	find(const K &key) const { return const_iterator(_rbt, _rbt.find(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, pair<iterator, iterator> >::type
+	equal_range(const K &key)
+	{
+		return make_pair(iterator(_rbt, _rbt.lower_bound(key)),
+						 iterator(_rbt, _rbt.upper_bound(key)));
+	}
+	template <class K>
+	typename enable_if_transparent<Compare, K, pair<const_iterator, const_iterator> >::type
+	equal_range(const K &key) const
+	{
+		return make_pair(const_iterator(_rbt, _rbt.lower_bound(key)),
+						 const_iterator(_rbt, _rbt.upper_bound(key)));
+	}
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	lower_bound(const K &key) { return iterator(_rbt, _rbt.lower_bound(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, const_iterator>::type
+	lower_bound(const K &key) const { return const_iterator(_rbt, _rbt.lower_bound(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, iterator>::type
+	upper_bound(const K &key) { return iterator(_rbt, _rbt.upper_bound(key)); }
+	template <class K>
+	typename enable_if_transparent<Compare, K, const_iterator>::type
+	upper_bound(const K &key) const { return const_iterator(_rbt, _rbt.upper_bound(key)); }
+
+	// the order statistics need Ranked
+	iterator nth(size_type k) { return iterator(_rbt, _rbt.select(k)); }
+	const_iterator nth(size_type k) const { return const_iterator(_rbt, _rbt.select(k)); }
+	size_type rank(const Key &key) const { return _rbt.rank(key); }
+	size_type count_range(const Key &lo, const Key &hi) const
+	{
+		size_type l = _rbt.rank(lo), h = _rbt.rank(hi);
+		return h > l ? h - l : 0;
+	}
+
+	/*
+	** Removes the keys in [lo, hi) and returns them as a set of their own, in
+	** O(log n) when Ranked, else plus the count of the smaller side. The nodes move rather than being copied, so the result keeps
+	** allocating from this set's allocator: under the default pool_allocator
+	** the two share a pool, which is not thread safe, and its memory lasts
+	** until both are gone. Copy the result for one that stands alone.
+	*/
+	set extract_range(const Key &lo, const Key &hi)
+	{
+		set mid(_comp, _rbt.get_allocator()), right(_comp, _rbt.get_allocator());
+		_rbt.split(lo, mid._rbt);
+		mid._rbt.split(hi, right._rbt);
+		_rbt.join(right._rbt);
+		return mid;
+	}
+
+	// set algebra, results are new sets, each with an allocator of its own as for a copy
+	set set_union(const set &other) const
+	{
+		return merged(other, tree::KEEP_LEFT | tree::KEEP_RIGHT | tree::KEEP_BOTH);
+	}
+	set set_intersection(const set &other) const { return merged(other, tree::KEEP_BOTH); }
+	set set_difference(const set &other) const { return merged(other, tree::KEEP_LEFT); }
+	set set_symmetric_difference(const set &other) const
+	{
+		return merged(other, tree::KEEP_LEFT | tree::KEEP_RIGHT);
+	}
+
+	key_compare key_comp() const { return _comp; }
+	value_compare value_comp() const { return _comp; }
 
 private:
-	Allocator _alloc;
 	Compare _comp;
-	rbtree<value_type, value_compare> _rbt;
+	tree _rbt;
+
+	// for results that share this tree's allocator (extract_range())
+	set(const Compare &comp, const typename tree::node_allocator &alloc) : _comp(comp),
+																		  _rbt(comp, alloc) {}
+
+	set merged(const set &other, int keep) const
+	{
+		set r(_comp, allocator_copy<typename tree::node_allocator>::select(_rbt.get_allocator()));
+		r._rbt.assign_merge(_rbt, other._rbt, keep);
+		return r;
+	}
 };
 
-template <class Key, class Compare, class Alloc>
-bool operator==(const ft::set<Key, Compare, Alloc> &lhs,
-				const ft::set<Key, Compare, Alloc> &rhs)
+template <class Key, class Compare, class Alloc, bool R>
+bool operator==(const ft::set<Key, Compare, Alloc, R> &lhs,
+				const ft::set<Key, Compare, Alloc, R> &rhs)
 {
 	if (lhs.size() != rhs.size())
 		return false;
-	typename ft::set<Key, Compare, Alloc>::const_iterator itl = lhs.begin();
-	typename ft::set<Key, Compare, Alloc>::const_iterator itr = rhs.begin();
+	typename ft::set<Key, Compare, Alloc, R>::const_iterator itl = lhs.begin();
+	typename ft::set<Key, Compare, Alloc, R>::const_iterator itr = rhs.begin();
 	while (itl != lhs.end() && *itl == *itr)
 	{
 		++itl;
@@ -152,16 +264,16 @@ bool operator==(const ft::set<Key, Compare, Alloc> &lhs,
 	return (itl == lhs.end());
 }
 
-template <class Key, class Compare, class Alloc>
-bool operator!=(const ft::set<Key, Compare, Alloc> &lhs,
-				const ft::set<Key, Compare, Alloc> &rhs) { return (!(lhs == rhs)); }
+template <class Key, class Compare, class Alloc, bool R>
+bool operator!=(const ft::set<Key, Compare, Alloc, R> &lhs,
+				const ft::set<Key, Compare, Alloc, R> &rhs) { return (!(lhs == rhs)); }
 
-template <class Key, class Compare, class Alloc>
-bool operator<(const ft::set<Key, Compare, Alloc> &lhs,
-			   const ft::set<Key, Compare, Alloc> &rhs)
+template <class Key, class Compare, class Alloc, bool R>
+bool operator<(const ft::set<Key, Compare, Alloc, R> &lhs,
+			   const ft::set<Key, Compare, Alloc, R> &rhs)
 {
-	typename ft::set<Key, Compare, Alloc>::const_iterator itl = lhs.begin();
-	typename ft::set<Key, Compare, Alloc>::const_iterator itr = rhs.begin();
+	typename ft::set<Key, Compare, Alloc, R>::const_iterator itl = lhs.begin();
+	typename ft::set<Key, Compare, Alloc, R>::const_iterator itr = rhs.begin();
 	while (itl != lhs.end() && itr != rhs.end() && *itl == *itr)
 	{
 		++itl;
@@ -170,18 +282,18 @@ bool operator<(const ft::set<Key, Compare, Alloc> &lhs,
 	return (itl == lhs.end() && itr != rhs.end()) || (itl != lhs.end() && itr != rhs.end() && *itl < *itr);
 }
 
-template <class Key, class Compare, class Alloc>
-bool operator<=(const ft::set<Key, Compare, Alloc> &lhs,
-				const ft::set<Key, Compare, Alloc> &rhs) { return (!(rhs < lhs)); }
+template <class Key, class Compare, class Alloc, bool R>
+bool operator<=(const ft::set<Key, Compare, Alloc, R> &lhs,
+				const ft::set<Key, Compare, Alloc, R> &rhs) { return (!(rhs < lhs)); }
 
-template <class Key, class Compare, class Alloc>
-bool operator>(const ft::set<Key, Compare, Alloc> &lhs,
-			   const ft::set<Key, Compare, Alloc> &rhs) { return (rhs < lhs); }
+template <class Key, class Compare, class Alloc, bool R>
+bool operator>(const ft::set<Key, Compare, Alloc, R> &lhs,
+			   const ft::set<Key, Compare, Alloc, R> &rhs) { return (rhs < lhs); }
 
-template <class Key, class Compare, class Alloc>
-bool operator>=(const ft::set<Key, Compare, Alloc> &lhs,
-				const ft::set<Key, Compare, Alloc> &rhs) { return (!(lhs < rhs)); }
+template <class Key, class Compare, class Alloc, bool R>
+bool operator>=(const ft::set<Key, Compare, Alloc, R> &lhs,
+				const ft::set<Key, Compare, Alloc, R> &rhs) { return (!(lhs < rhs)); }
 
-template <class Key, class Compare, class Alloc>
-void swap(ft::set<Key, Compare, Alloc> &lhs,
-		  ft::set<Key, Compare, Alloc> &rhs) { lhs.swap(rhs); }
+template <class Key, class Compare, class Alloc, bool R>
+void swap(ft::set<Key, Compare, Alloc, R> &lhs,
+		  ft::set<Key, Compare, Alloc, R> &rhs) { lhs.swap(rhs); }
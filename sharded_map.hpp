@@ -0,0 +1,301 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <functional>
+#include <pthread.h>
+#include "map.hpp"
+#include "vector.hpp"
+#include "functional.hpp"
+
+namespace ft
+{
+	template <class Key, class T, class Compare = std::less<Key>, std::size_t Shards = 16,
+			  class Hash = ft::hash<Key>,
+			  class Allocator = ft::pool_allocator<pair<const Key, T> > >
+	class sharded_map;
+}
+
+/*
+** Map for many writing threads: keys are hash-partitioned over Shards
+** independent ft::maps, each behind its own reader-writer lock and with its
+** own copy of the allocator (a pool of its own, for pool_allocator), so
+** writers to different shards share nothing. Hashing rather than ranges
+** keeps the shards even whatever the keys look like; ordered traversal
+** pays for it by merging the shards.
+**
+** Elements are handed out by value only, since a reference would outlive
+** the shard's lock. Batched operations take each shard's lock once for
+** all the keys falling into it, one shard at a time; no operation holds
+** more than one write lock, so they can't deadlock. size() and the
+** traversals are exact only when no update is running.
+*/
+template <class Key, class T, class Compare, std::size_t Shards, class Hash, class Allocator>
+class ft::sharded_map
+{
+public:
+	typedef Key key_type;
+	typedef T mapped_type;
+	typedef pair<const Key, T> value_type;
+	typedef std::size_t size_type;
+	typedef Compare key_compare;
+	typedef Hash hasher;
+	typedef Allocator allocator_type;
+	typedef ft::map<Key, T, Compare, Allocator> shard_type;
+
+	explicit sharded_map(const Compare &comp = Compare(),
+						 const Hash &hash = Hash(),
+						 const Allocator &alloc = Allocator()) : _hash(hash),
+																 _shards(static_cast<shard *>(::operator new(Shards * sizeof(shard))))
+	{
+		size_type i = 0;
+		try
+		{
+			for (; i < Shards; i++)
+				new (&_shards[i]) shard(comp, alloc);
+		}
+		catch (...)
+		{
+			while (i--)
+				_shards[i].~shard();
+			::operator delete(_shards);
+			throw;
+		}
+	}
+	// no other thread may be using the map
+	~sharded_map()
+	{
+		for (size_type i = 0; i < Shards; i++)
+			_shards[i].~shard();
+		::operator delete(_shards);
+	}
+
+	// false, leaving the map as it was, when key is already there
+	bool insert(const value_type &value)
+	{
+		shard &s = shard_of(value.first);
+		write_lock lock(s);
+		return s.m.insert(value).second;
+	}
+	// true if key is new
+	template <class M>
+	bool insert_or_assign(const Key &key, const M &obj)
+	{
+		shard &s = shard_of(key);
+		write_lock lock(s);
+		return s.m.insert_or_assign(key, obj).second;
+	}
+	size_type erase(const Key &key)
+	{
+		shard &s = shard_of(key);
+		write_lock lock(s);
+		return s.m.erase(key);
+	}
+	void clear()
+	{
+		for (size_type i = 0; i < Shards; i++)
+		{
+			write_lock lock(_shards[i]);
+			_shards[i].m.clear();
+		}
+	}
+
+	size_type count(const Key &key) const
+	{
+		const shard &s = shard_of(key);
+		read_lock lock(s);
+		return s.m.count(key);
+	}
+	// copies the mapped value out; false if key isn't there
+	bool find(const Key &key, T &out) const
+	{
+		const shard &s = shard_of(key);
+		read_lock lock(s);
+		typename shard_type::const_iterator it = s.m.find(key);
+		if (it == s.m.end())
+			return false;
+		out = it->second;
+		return true;
+	}
+	size_type size() const
+	{
+		size_type n = 0;
+		for (size_type i = 0; i < Shards; i++)
+		{
+			read_lock lock(_shards[i]);
+			n += _shards[i].m.size();
+		}
+		return n;
+	}
+	bool empty() const { return size() == 0; }
+
+	// batched: the values are sorted out by shard first; returns how many were new
+	template <class InputIt>
+	size_type insert(InputIt first, InputIt last)
+	{
+		ft::vector<value_type> batch[Shards];
+		for (; first != last; ++first)
+			batch[index_of(first->first)].push_back(*first);
+		size_type n = 0;
+		for (size_type i = 0; i < Shards; i++)
+			if (!batch[i].empty())
+			{
+				write_lock lock(_shards[i]);
+				size_type before = _shards[i].m.size();
+				_shards[i].m.insert(batch[i].begin(), batch[i].end());
+				n += _shards[i].m.size() - before;
+			}
+		return n;
+	}
+	// batched erase of the keys in [first, last); returns how many were there
+	template <class InputIt>
+	size_type erase(InputIt first, InputIt last)
+	{
+		ft::vector<Key> batch[Shards];
+		for (; first != last; ++first)
+			batch[index_of(*first)].push_back(*first);
+		size_type n = 0;
+		for (size_type i = 0; i < Shards; i++)
+			if (!batch[i].empty())
+			{
+				write_lock lock(_shards[i]);
+				for (size_type j = 0; j < batch[i].size(); j++)
+					n += _shards[i].m.erase(batch[i][j]);
+			}
+		return n;
+	}
+	// batched lookup: how many of the keys in [first, last) are there
+	template <class InputIt>
+	size_type count(InputIt first, InputIt last) const
+	{
+		ft::vector<Key> batch[Shards];
+		for (; first != last; ++first)
+			batch[index_of(*first)].push_back(*first);
+		size_type n = 0;
+		for (size_type i = 0; i < Shards; i++)
+			if (!batch[i].empty())
+			{
+				read_lock lock(_shards[i]);
+				for (size_type j = 0; j < batch[i].size(); j++)
+					n += _shards[i].m.count(batch[i][j]);
+			}
+		return n;
+	}
+
+	/*
+	** Calls f(value) on every element in key order, merging the shards
+	** through a heap of their cursors. All the read locks are held
+	** throughout, so f sees one consistent state but must not call back
+	** into the map to update it.
+	*/
+	template <class F>
+	F for_each(F f) const { return walk(NULL, NULL, f); }
+	// the same over [lo, hi)
+	template <class F>
+	F for_each(const Key &lo, const Key &hi, F f) const { return walk(&lo, &hi, f); }
+
+	key_compare key_comp() const { return _shards[0].m.key_comp(); }
+	hasher hash_function() const { return _hash; }
+
+private:
+	typedef typename shard_type::const_iterator cursor;
+
+	// padded so that two shards' locks never share a cache line
+	struct shard
+	{
+		shard(const Compare &comp, const Allocator &alloc) : m(comp, allocator_copy<Allocator>::select(alloc))
+		{
+			if (pthread_rwlock_init(&lock, NULL))
+				throw std::bad_alloc();
+		}
+		~shard() { pthread_rwlock_destroy(&lock); }
+		pthread_rwlock_t lock;
+		shard_type m;
+		char pad[64];
+	};
+	struct read_lock
+	{
+		explicit read_lock(const shard &s) : _s(const_cast<shard &>(s)) { pthread_rwlock_rdlock(&_s.lock); }
+		~read_lock() { pthread_rwlock_unlock(&_s.lock); }
+		shard &_s;
+	};
+	struct write_lock
+	{
+		explicit write_lock(shard &s) : _s(s) { pthread_rwlock_wrlock(&_s.lock); }
+		~write_lock() { pthread_rwlock_unlock(&_s.lock); }
+		shard &_s;
+	};
+
+	sharded_map(const sharded_map &);
+	sharded_map &operator=(const sharded_map &);
+
+	// the same mixing as hash_table, so that plain integer keys spread too
+	size_type index_of(const Key &key) const
+	{
+		size_type h = _hash(key);
+		const size_type phi = (size_type(0x9E3779B9) << (sizeof(size_type) * 4)) | 0x7F4A7C15;
+		h *= phi;
+		return (h ^ (h >> (sizeof(size_type) * 4))) % Shards;
+	}
+	shard &shard_of(const Key &key) { return _shards[index_of(key)]; }
+	const shard &shard_of(const Key &key) const { return _shards[index_of(key)]; }
+
+	template <class F>
+	F walk(const Key *lo, const Key *hi, F f) const
+	{
+		cursor at[Shards], end[Shards];
+		size_type heap[Shards], n = 0;
+		for (size_type i = 0; i < Shards; i++)
+			pthread_rwlock_rdlock(&_shards[i].lock);
+		for (size_type i = 0; i < Shards; i++)
+		{
+			const shard_type &m = _shards[i].m;
+			at[i] = lo ? m.lower_bound(*lo) : m.begin();
+			end[i] = hi ? m.lower_bound(*hi) : m.end();
+			if (at[i] != end[i])
+				heap[n++] = i;
+		}
+		for (size_type i = n / 2; i-- > 0;)
+			sift_down(heap, n, i, at);
+		try
+		{
+			while (n)
+			{
+				size_type i = heap[0];
+				f(*at[i]);
+				if (++at[i] == end[i])
+					heap[0] = heap[--n];
+				sift_down(heap, n, 0, at);
+			}
+		}
+		catch (...)
+		{
+			unlock_all();
+			throw;
+		}
+		unlock_all();
+		return f;
+	}
+	// min-heap of shard indices ordered by their cursors' keys
+	void sift_down(size_type *heap, size_type n, size_type i, const cursor *at) const
+	{
+		const Compare &comp = _shards[0].m.key_comp();
+		for (size_type c; (c = 2 * i + 1) < n; i = c)
+		{
+			if (c + 1 < n && comp(at[heap[c + 1]]->first, at[heap[c]]->first))
+				c++;
+			if (!comp(at[heap[c]]->first, at[heap[i]]->first))
+				break;
+			size_type t = heap[i];
+			heap[i] = heap[c];
+			heap[c] = t;
+		}
+	}
+	void unlock_all() const
+	{
+		for (size_type i = Shards; i-- > 0;)
+			pthread_rwlock_unlock(&_shards[i].lock);
+	}
+
+	Hash _hash;
+	shard *_shards;
+};
@@ -0,0 +1,158 @@
+#pragma once
+#include <memory>
+#include <utility>
+#include "traits.hpp"
+#include "uninitialized.hpp"
+#include "vector.hpp"
+
+namespace ft
+{
+	template <class T, std::size_t N, class A = std::allocator<T>, class Growth = geometric_growth<2, 1> >
+	class small_vector;
+}
+
+/*
+** A vector that keeps its first N elements inside the object and only
+** allocates once it outgrows them; shrink_to_fit() moves them back in when
+** they fit again. Everything else, growth included, is ft::vector's (see
+** vector_base). Iterators into the inline buffer do not survive a move or
+** swap.
+*/
+template <class T, std::size_t N, class A, class Growth>
+class ft::small_vector : public ft::vector_base<T, A, Growth, ft::small_vector<T, N, A, Growth> >
+{
+	typedef vector_base<T, A, Growth, small_vector> base;
+	friend class vector_base<T, A, Growth, small_vector>;
+	// no inline buffer is what ft::vector is for
+	typedef char inline_capacity_must_be_positive[N > 0 ? 1 : -1];
+
+public:
+	typedef typename base::size_type size_type;
+
+	small_vector() : base(A()) { init(); }
+	explicit small_vector(const A &alloc) : base(alloc) { init(); }
+	explicit small_vector(size_type count, const T &value = T(),
+						  const A &alloc = A()) : base(alloc)
+	{
+		init();
+		this->init_fill(count, value);
+	}
+	small_vector(const small_vector &other) : base(allocator_copy<A>::select(other._alloc))
+	{
+		init();
+		this->init_copy(other);
+	}
+#if __cplusplus >= 201103L
+	small_vector(small_vector &&other) : base(other._alloc)
+	{
+		init();
+		steal(other);
+	}
+#endif
+	template <class InputIt>
+	small_vector(InputIt first, InputIt last,
+				 const A &alloc = A()) : base(alloc)
+	{
+		init();
+		this->init_range(first, last);
+	}
+	~small_vector()
+	{
+		ops::destroy(_alloc, _values, _values + _size);
+		deallocate(_values, _capacity);
+	}
+	small_vector &operator=(const small_vector &other)
+	{
+		this->assign_copy(other);
+		return *this;
+	}
+#if __cplusplus >= 201103L
+	small_vector &operator=(small_vector &&other)
+	{
+		if (this != &other)
+		{
+			this->clear();
+			steal(other);
+		}
+		return *this;
+	}
+#endif
+	// true while the elements live inside the object
+	bool is_inline() const { return _values == inline_buffer(); }
+	void shrink_to_fit()
+	{
+		if (is_inline() || _capacity == _size)
+			return;
+		if (_size > N)
+		{
+			this->reallocate(_size);
+			return;
+		}
+		T *heap = _values;
+		ops::relocate(_alloc, inline_buffer(), heap, _size);
+		_alloc.deallocate(heap, _capacity);
+		_values = inline_buffer();
+		_capacity = N;
+	}
+	void swap(small_vector &other)
+	{
+		if (!is_inline() && !other.is_inline())
+		{
+			std::swap(_values, other._values);
+			std::swap(_size, other._size);
+			std::swap(_capacity, other._capacity);
+			std::swap(_alloc, other._alloc);
+			return;
+		}
+		small_vector t(_alloc);
+		t.steal(*this);
+		steal(other);
+		other.steal(t);
+	}
+
+private:
+	using base::_alloc;
+	using base::_capacity;
+	using base::_size;
+	using base::_values;
+	typedef typename base::ops ops;
+
+	char _inline[N * sizeof(T)] __attribute__((aligned(__alignof__(T))));
+
+	void init()
+	{
+		_values = inline_buffer();
+		_capacity = N;
+	}
+	T *inline_buffer() { return reinterpret_cast<T *>(_inline); }
+	const T *inline_buffer() const { return reinterpret_cast<const T *>(_inline); }
+	// the inline buffer is never freed
+	void deallocate(T *p, size_type n)
+	{
+		if (p != inline_buffer())
+			_alloc.deallocate(p, n);
+	}
+	// takes other's elements into this empty vector, leaving other empty
+	void steal(small_vector &other)
+	{
+		deallocate(_values, _capacity);
+		if (other.is_inline())
+		{
+			init();
+			ops::relocate(_alloc, _values, other._values, other._size);
+		}
+		else
+		{
+			_alloc = other._alloc;
+			_values = other._values;
+			_capacity = other._capacity;
+			other.init();
+		}
+		_size = other._size;
+		other._size = 0;
+	}
+};
+
+template <class T, std::size_t N, class A, class G>
+void swap(ft::small_vector<T, N, A, G> &lhs,
+		  ft::small_vector<T, N, A, G> &rhs) { lhs.swap(rhs); }
@@ -7,6 +7,11 @@ namespace ft
 	class stack;
 }
 
+/*
+** Container defaults to ft::vector. For deep stacks of big elements,
+** ft::deque (deque.hpp) grows without copying anything and keeps
+** references to the elements valid.
+*/
 template <class T, class Container>
 class ft::stack
 {
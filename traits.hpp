@@ -1,4 +1,5 @@
 #pragma once
+#include <memory>
 
 namespace ft
 {
@@ -40,6 +41,12 @@ struct integral_constant{
 typedef integral_constant<bool, true> true_type;
 typedef integral_constant<bool, false> false_type;
 
+template <class T, class U> struct is_same : false_type {};
+template <class T> struct is_same<T, T> : true_type {};
+
+template <class T> struct remove_const { typedef T type; };
+template <class T> struct remove_const<const T> { typedef T type; };
+
 template <class T> struct is_integral : false_type {};
 template <> struct is_integral<bool> : true_type{};
 template <> struct is_integral<char> : true_type{};
@@ -55,4 +62,51 @@ template <> struct is_integral<unsigned long> : true_type{};
 //template <> struct is_integral<long long> : true_type{};
 //template <> struct is_integral<unsigned long long> : true_type{};
 
+template <class T>
+struct void_type { typedef void type; };
+
+// Compare::is_transparent opts a comparator into heterogeneous lookup
+template <class T, class = void>
+struct is_transparent : false_type {};
+template <class T>
+struct is_transparent<T, typename void_type<typename T::is_transparent>::type> : true_type {};
+// enable_if on is_transparent, spelled with the lookup type K so that it
+// stays a substitution failure in member templates
+template <class Compare, class K, class R>
+struct enable_if_transparent : enable_if<is_transparent<Compare>::value, R> {};
+
+#ifdef __clang__
+template <class T>
+struct is_trivially_destructible : integral_constant<bool, __is_trivially_destructible(T)> {};
+#else
+template <class T>
+struct is_trivially_destructible : integral_constant<bool, __has_trivial_destructor(T)> {};
+#endif
+
+// safe to copy, relocate and shift as raw bytes
+template <class T>
+struct is_trivially_copyable : integral_constant<bool, __is_trivially_copyable(T)> {};
+
+// allocators whose deallocate() is a no-op, so containers may skip it
+template <class A> struct is_monotonic_allocator : false_type {};
+
+// allocators that several threads may allocate from and deallocate into at once
+template <class A> struct is_concurrent_allocator : false_type {};
+template <class T> struct is_concurrent_allocator<std::allocator<T> > : true_type {};
+
+// allocators one copy of which can take over the memory of another (pool_allocator),
+// so that threads may each allocate from a fresh copy of their own and hand it back
+template <class A>
+struct allocator_splice : false_type
+{
+	static void splice(A &, A &) {}
+};
+
+// allocator a container copy starts with (select_on_container_copy_construction)
+template <class A>
+struct allocator_copy
+{
+	static A select(const A &a) { return a; }
+};
+
 }
@@ -0,0 +1,195 @@
+#pragma once
+#include <cstring>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include "traits.hpp"
+
+namespace ft
+{
+	template <class T, class A>
+	struct uninitialized;
+}
+
+/*
+** Element transfer for contiguous containers (vector, small_vector).
+** Trivially copyable types move as raw bytes (memcpy/memmove); everything
+** else is copy constructed into raw memory or copy assigned over live
+** elements, one at a time. Built as C++11, relocation and shifting move
+** instead (relocation only when the move can't throw), so growing never
+** deep-copies e.g. strings.
+*/
+template <class T, class A>
+struct ft::uninitialized
+{
+	typedef std::size_t size_type;
+	typedef is_trivially_copyable<T> trivial;
+
+#if __cplusplus >= 201103L
+	template <class... Args>
+	static void construct(A &a, T *p, Args &&...args)
+	{
+		std::allocator_traits<A>::construct(a, p, std::forward<Args>(args)...);
+	}
+	static void destroy_at(A &a, T *p) { std::allocator_traits<A>::destroy(a, p); }
+	// what relocation and shifting build/assign from: moved-from sources
+	static auto relocated(T &x) -> decltype(std::move_if_noexcept(x)) { return std::move_if_noexcept(x); }
+	static T &&shifted(T &x) { return std::move(x); }
+#else
+	static void construct(A &a, T *p, const T &value) { a.construct(p, value); }
+	static void destroy_at(A &a, T *p) { a.destroy(p); }
+	static const T &relocated(T &x) { return x; }
+	static const T &shifted(T &x) { return x; }
+#endif
+
+	static void destroy(A &a, T *first, T *last) { destroy(a, first, last, is_trivially_destructible<T>()); }
+	static void destroy(A &, T *, T *, true_type) {}
+	static void destroy(A &a, T *first, T *last, false_type)
+	{
+		for (; first != last; ++first)
+			destroy_at(a, first);
+	}
+	// n copies of src into raw memory at dst
+	static void construct_copy(A &a, T *dst, const T *src, size_type n) { construct_copy(a, dst, src, n, trivial()); }
+	static void construct_copy(A &, T *dst, const T *src, size_type n, true_type)
+	{
+		if (n)
+			std::memcpy(static_cast<void *>(dst), src, n * sizeof(T));
+	}
+	static void construct_copy(A &a, T *dst, const T *src, size_type n, false_type)
+	{
+		construct_range(a, dst, src, n);
+	}
+	template <class InputIt>
+	static void construct_range(A &a, T *dst, InputIt first, size_type n)
+	{
+		size_type i = 0;
+		try
+		{
+			for (; i < n; ++i, ++first)
+				construct(a, dst + i, *first);
+		}
+		catch (...)
+		{
+			destroy(a, dst, dst + i);
+			throw;
+		}
+	}
+	static void construct_fill(A &a, T *dst, size_type n, const T &value)
+	{
+		size_type i = 0;
+		try
+		{
+			for (; i < n; ++i)
+				construct(a, dst + i, value);
+		}
+		catch (...)
+		{
+			destroy(a, dst, dst + i);
+			throw;
+		}
+	}
+	// n copies of src over live elements at dst
+	static void copy_assign(T *dst, const T *src, size_type n) { copy_assign(dst, src, n, trivial()); }
+	static void copy_assign(T *dst, const T *src, size_type n, true_type)
+	{
+		if (n)
+			std::memcpy(static_cast<void *>(dst), src, n * sizeof(T));
+	}
+	static void copy_assign(T *dst, const T *src, size_type n, false_type)
+	{
+		for (size_type i = 0; i < n; i++)
+			dst[i] = src[i];
+	}
+	/*
+	** Moves n live elements from src to raw memory at dst, leaving src raw.
+	** Every element is built before its source goes: all at once into
+	** another buffer, in blocks as wide as the shift within one, so each
+	** block lands on memory already vacated. A throw undoes the blocks
+	** moved so far and leaves src as it was (only a copy throwing again
+	** on the way back could tear it).
+	*/
+	static void relocate(A &a, T *dst, T *src, size_type n) { relocate(a, dst, src, n, trivial()); }
+	static void relocate(A &, T *dst, T *src, size_type n, true_type)
+	{
+		if (n)
+			std::memmove(static_cast<void *>(dst), src, n * sizeof(T));
+	}
+	static void relocate(A &a, T *dst, T *src, size_type n, false_type)
+	{
+		if (dst == src || !n)
+			return;
+		size_type gap = dst > src ? dst - src : src - dst;
+		if (gap >= n)
+		{
+			construct_relocated(a, dst, src, n);
+			destroy(a, src, src + n);
+			return;
+		}
+		size_type i = 0, blocks = (n + gap - 1) / gap;
+		try
+		{
+			for (; i < blocks; i++)
+				relocate_block(a, dst, src, n, gap, i, false);
+		}
+		catch (...)
+		{
+			while (i--)
+				relocate_block(a, dst, src, n, gap, i, true);
+			throw;
+		}
+	}
+	// relocates size elements to another buffer, leaving [idx, idx + n) raw there
+	static void relocate_around(A &a, T *dst, T *src, size_type size, size_type idx, size_type n)
+	{
+		construct_relocated(a, dst, src, idx);
+		try { construct_relocated(a, dst + idx + n, src + idx, size - idx); }
+		catch (...) { destroy(a, dst, dst + idx); throw; }
+		destroy(a, src, src + size);
+	}
+	// block i, counted from the end that moves first, of an overlapping relocation (or back)
+	static void relocate_block(A &a, T *dst, T *src, size_type n, size_type gap, size_type i, bool back)
+	{
+		size_type lo = i * gap, k = n - lo < gap ? n - lo : gap;
+		if (dst > src)
+			lo = n - lo - k;
+		T *from = (back ? dst : src) + lo, *to = (back ? src : dst) + lo;
+		construct_relocated(a, to, from, k);
+		destroy(a, from, from + k);
+	}
+	// builds relocated copies of n elements in raw memory at dst; src stays live
+	static void construct_relocated(A &a, T *dst, T *src, size_type n) { construct_relocated(a, dst, src, n, trivial()); }
+	static void construct_relocated(A &, T *dst, T *src, size_type n, true_type)
+	{
+		if (n)
+			std::memcpy(static_cast<void *>(dst), src, n * sizeof(T));
+	}
+	static void construct_relocated(A &a, T *dst, T *src, size_type n, false_type)
+	{
+		size_type i = 0;
+		try
+		{
+			for (; i < n; ++i)
+				construct(a, dst + i, relocated(src[i]));
+		}
+		catch (...)
+		{
+			destroy(a, dst, dst + i);
+			throw;
+		}
+	}
+	// closes the n elements at dst by moving the count live ones at src down
+	static void shift_down(A &a, T *dst, T *src, size_type count) { shift_down(a, dst, src, count, trivial()); }
+	static void shift_down(A &a, T *dst, T *src, size_type count, true_type)
+	{
+		relocate(a, dst, src, count, true_type());
+	}
+	static void shift_down(A &a, T *dst, T *src, size_type count, false_type)
+	{
+		if (dst == src)
+			return;
+		for (size_type i = 0; i < count; i++)
+			dst[i] = shifted(src[i]);
+		destroy(a, dst + count, src + count);
+	}
+};
@@ -0,0 +1,195 @@
+#pragma once
+#include <stdexcept>
+#include "hash_table.hpp"
+
+namespace ft
+{
+	template <class Key, class T, class Hash = ft::hash<Key>,
+			  class KeyEqual = std::equal_to<Key>,
+			  class Allocator = std::allocator<pair<const Key, T> > >
+	class unordered_map;
+}
+
+/*
+** Hash map for point lookups (see hash_table.hpp). Elements are stored in
+** the table itself, so inserts invalidate iterators and references, and
+** iteration order is unspecified. The allocator gets whole slot arrays,
+** hence std::allocator rather than map's node pool by default.
+*/
+template <class Key, class T, class Hash, class KeyEqual, class Allocator>
+class ft::unordered_map
+{
+public:
+	typedef Key key_type;
+	typedef T mapped_type;
+	typedef pair<const Key, T> value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef Hash hasher;
+	typedef KeyEqual key_equal;
+	typedef Allocator allocator_type;
+	typedef value_type &reference;
+	typedef const value_type &const_reference;
+	typedef typename Allocator::pointer pointer;
+	typedef typename Allocator::const_pointer const_pointer;
+
+private:
+	typedef hash_table<value_type, Hash, KeyEqual, Allocator, select_first<value_type> > table;
+
+public:
+	typedef typename table::iterator iterator;
+	typedef typename table::const_iterator const_iterator;
+
+	iterator begin() { return _ht.begin(); }
+	const_iterator begin() const { return _ht.begin(); }
+	iterator end() { return _ht.end(); }
+	const_iterator end() const { return _ht.end(); }
+
+	unordered_map() {}
+	explicit unordered_map(size_type n,
+						   const Hash &hash = Hash(),
+						   const KeyEqual &eq = KeyEqual(),
+						   const Allocator &alloc = Allocator()) : _alloc(alloc),
+																   _ht(n, hash, eq, alloc) {}
+	template <class InputIt>
+	unordered_map(InputIt first, InputIt last,
+				  size_type n = 0,
+				  const Hash &hash = Hash(),
+				  const KeyEqual &eq = KeyEqual(),
+				  const Allocator &alloc = Allocator()) : _alloc(alloc),
+														  _ht(n, hash, eq, alloc)
+	{
+		_ht.insert_range(first, last);
+	}
+	unordered_map(const unordered_map &other) : _alloc(allocator_copy<Allocator>::select(other._alloc)),
+												_ht(other._ht) {}
+	~unordered_map() {}
+	unordered_map &operator=(const unordered_map &other)
+	{
+		if (this == &other)
+			return (*this);
+		_ht = other._ht;
+		return (*this);
+	}
+	allocator_type get_allocator() const { return _alloc; }
+
+	T &at(const Key &key)
+	{
+		iterator it = find(key);
+		if (it != end())
+			return it->second;
+		throw std::out_of_range("no element with key");
+	}
+	const T &at(const Key &key) const
+	{
+		const_iterator it = find(key);
+		if (it != end())
+			return it->second;
+		throw std::out_of_range("no element with key");
+	}
+	T &operator[](const Key &key) { return try_emplace(key).first->second; }
+	// the mapped value is only built (from arg, if given) for a new key
+	pair<iterator, bool> try_emplace(const Key &key)
+	{
+		make_default make = {key};
+		return _ht.insert_unique(key, make);
+	}
+	template <class A1>
+	pair<iterator, bool> try_emplace(const Key &key, const A1 &arg)
+	{
+		make_from<A1> make = {key, arg};
+		return _ht.insert_unique(key, make);
+	}
+	template <class M>
+	pair<iterator, bool> insert_or_assign(const Key &key, const M &obj)
+	{
+		pair<iterator, bool> r = try_emplace(key, obj);
+		if (!r.second)
+			r.first->second = obj;
+		return r;
+	}
+
+	bool empty() const { return _ht.empty(); }
+	size_type size() const { return _ht.size(); }
+	size_type max_size() const { return _ht.max_size(); }
+	void clear() { _ht.clear(); }
+	pair<iterator, bool> insert(const value_type &value) { return _ht.insert(value); }
+	iterator insert(const_iterator, const value_type &value) { return _ht.insert(value).first; }
+	template <class InputIt>
+	void insert(InputIt first, InputIt last)
+	{
+		_ht.insert_range(first, last);
+	}
+	iterator erase(const_iterator pos) { return _ht.erase(pos); }
+	iterator erase(const_iterator first, const_iterator last) { return _ht.erase(first, last); }
+	size_type erase(const key_type &key) { return _ht.erase_key(key); }
+	void swap(unordered_map &other)
+	{
+		std::swap(_alloc, other._alloc);
+		_ht.swap(other._ht);
+	}
+
+	size_type count(const Key &key) const { return find(key) != end(); }
+	iterator find(const Key &key) { return _ht.find(key); }
+	const_iterator find(const Key &key) const { return _ht.find(key); }
+	pair<iterator, iterator> equal_range(const Key &key)
+	{
+		iterator it = find(key);
+		return make_pair(it, it == end() ? it : ++iterator(it));
+	}
+	pair<const_iterator, const_iterator> equal_range(const Key &key) const
+	{
+		const_iterator it = find(key);
+		return make_pair(it, it == end() ? it : ++const_iterator(it));
+	}
+
+	// slots, not chained buckets: the load factor never exceeds 7/8
+	size_type bucket_count() const { return _ht.slot_count(); }
+	float load_factor() const { return bucket_count() ? float(size()) / bucket_count() : 0; }
+	float max_load_factor() const { return 0.875f; }
+	void rehash(size_type n) { _ht.reserve(n - n / 8); }
+	void reserve(size_type n) { _ht.reserve(n); }
+	hasher hash_function() const { return _ht.hash_function(); }
+	key_equal key_eq() const { return _ht.key_eq(); }
+
+private:
+	struct make_default
+	{
+		const Key &key;
+		void operator()(value_type *p) const { new (p) value_type(key, T()); }
+	};
+	template <class A1>
+	struct make_from
+	{
+		const Key &key;
+		const A1 &arg;
+		void operator()(value_type *p) const { new (p) value_type(key, arg); }
+	};
+
+	Allocator _alloc;
+	table _ht;
+};
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+bool operator==(const ft::unordered_map<Key, T, Hash, KeyEqual, Alloc> &lhs,
+				const ft::unordered_map<Key, T, Hash, KeyEqual, Alloc> &rhs)
+{
+	if (lhs.size() != rhs.size())
+		return false;
+	typename ft::unordered_map<Key, T, Hash, KeyEqual, Alloc>::const_iterator it, found;
+	for (it = lhs.begin(); it != lhs.end(); ++it)
+	{
+		found = rhs.find(it->first);
+		if (found == rhs.end() || !(found->second == it->second))
+			return false;
+	}
+	return true;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+bool operator!=(const ft::unordered_map<Key, T, Hash, KeyEqual, Alloc> &lhs,
+				const ft::unordered_map<Key, T, Hash, KeyEqual, Alloc> &rhs) { return (!(lhs == rhs)); }
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+void swap(ft::unordered_map<Key, T, Hash, KeyEqual, Alloc> &lhs,
+		  ft::unordered_map<Key, T, Hash, KeyEqual, Alloc> &rhs) { lhs.swap(rhs); }
@@ -0,0 +1,132 @@
+#pragma once
+#include "hash_table.hpp"
+
+namespace ft
+{
+	template <class Key, class Hash = ft::hash<Key>,
+			  class KeyEqual = std::equal_to<Key>,
+			  class Allocator = std::allocator<Key> >
+	class unordered_set;
+}
+
+// hash set over the same table as unordered_map, with the same caveats
+template <class Key, class Hash, class KeyEqual, class Allocator>
+class ft::unordered_set
+{
+public:
+	typedef Key key_type;
+	typedef Key value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef Hash hasher;
+	typedef KeyEqual key_equal;
+	typedef Allocator allocator_type;
+	typedef value_type &reference;
+	typedef const value_type &const_reference;
+	typedef typename Allocator::pointer pointer;
+	typedef typename Allocator::const_pointer const_pointer;
+
+private:
+	typedef hash_table<value_type, Hash, KeyEqual, Allocator> table;
+
+public:
+	typedef typename table::const_iterator iterator;
+	typedef typename table::const_iterator const_iterator;
+
+	iterator begin() const { return _ht.begin(); }
+	iterator end() const { return _ht.end(); }
+
+	unordered_set() {}
+	explicit unordered_set(size_type n,
+						   const Hash &hash = Hash(),
+						   const KeyEqual &eq = KeyEqual(),
+						   const Allocator &alloc = Allocator()) : _alloc(alloc),
+																   _ht(n, hash, eq, alloc) {}
+	template <class InputIt>
+	unordered_set(InputIt first, InputIt last,
+				  size_type n = 0,
+				  const Hash &hash = Hash(),
+				  const KeyEqual &eq = KeyEqual(),
+				  const Allocator &alloc = Allocator()) : _alloc(alloc),
+														  _ht(n, hash, eq, alloc)
+	{
+		_ht.insert_range(first, last);
+	}
+	unordered_set(const unordered_set &other) : _alloc(allocator_copy<Allocator>::select(other._alloc)),
+												_ht(other._ht) {}
+	~unordered_set() {}
+	unordered_set &operator=(const unordered_set &other)
+	{
+		if (this == &other)
+			return (*this);
+		_ht = other._ht;
+		return (*this);
+	}
+	allocator_type get_allocator() const { return _alloc; }
+
+	bool empty() const { return _ht.empty(); }
+	size_type size() const { return _ht.size(); }
+	size_type max_size() const { return _ht.max_size(); }
+	void clear() { _ht.clear(); }
+	pair<iterator, bool> insert(const value_type &value)
+	{
+		pair<typename table::iterator, bool> p = _ht.insert(value);
+		return make_pair(iterator(p.first), p.second);
+	}
+	iterator insert(const_iterator, const value_type &value) { return _ht.insert(value).first; }
+	template <class InputIt>
+	void insert(InputIt first, InputIt last)
+	{
+		_ht.insert_range(first, last);
+	}
+	iterator erase(const_iterator pos) { return _ht.erase(pos); }
+	iterator erase(const_iterator first, const_iterator last) { return _ht.erase(first, last); }
+	size_type erase(const key_type &key) { return _ht.erase_key(key); }
+	void swap(unordered_set &other)
+	{
+		std::swap(_alloc, other._alloc);
+		_ht.swap(other._ht);
+	}
+
+	size_type count(const Key &key) const { return find(key) != end(); }
+	iterator find(const Key &key) const { return _ht.find(key); }
+	pair<iterator, iterator> equal_range(const Key &key) const
+	{
+		iterator it = find(key);
+		return make_pair(it, it == end() ? it : ++iterator(it));
+	}
+
+	// slots, not chained buckets: the load factor never exceeds 7/8
+	size_type bucket_count() const { return _ht.slot_count(); }
+	float load_factor() const { return bucket_count() ? float(size()) / bucket_count() : 0; }
+	float max_load_factor() const { return 0.875f; }
+	void rehash(size_type n) { _ht.reserve(n - n / 8); }
+	void reserve(size_type n) { _ht.reserve(n); }
+	hasher hash_function() const { return _ht.hash_function(); }
+	key_equal key_eq() const { return _ht.key_eq(); }
+
+private:
+	Allocator _alloc;
+	table _ht;
+};
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+bool operator==(const ft::unordered_set<Key, Hash, KeyEqual, Alloc> &lhs,
+				const ft::unordered_set<Key, Hash, KeyEqual, Alloc> &rhs)
+{
+	if (lhs.size() != rhs.size())
+		return false;
+	typename ft::unordered_set<Key, Hash, KeyEqual, Alloc>::const_iterator it;
+	for (it = lhs.begin(); it != lhs.end(); ++it)
+		if (rhs.find(*it) == rhs.end())
+			return false;
+	return true;
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+bool operator!=(const ft::unordered_set<Key, Hash, KeyEqual, Alloc> &lhs,
+				const ft::unordered_set<Key, Hash, KeyEqual, Alloc> &rhs) { return (!(lhs == rhs)); }
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+void swap(ft::unordered_set<Key, Hash, KeyEqual, Alloc> &lhs,
+		  ft::unordered_set<Key, Hash, KeyEqual, Alloc> &rhs) { lhs.swap(rhs); }
@@ -1,22 +1,47 @@
 #pragma once
 #include <sstream>
+#include <memory>
+#include <utility>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 #include "traits.hpp"
+#include "uninitialized.hpp"
 #include "reverse_iterator.hpp"
 
 namespace ft
 {
-	template <class T, class A = std::allocator<T> >
+	template <unsigned Num, unsigned Den>
+	struct geometric_growth;
+	template <class T, class A>
+	struct vector_iterators;
+	template <class T, class A, class Growth, class Buffer>
+	class vector_base;
+	template <class T, class A = std::allocator<T>, class Growth = geometric_growth<2, 1> >
 	class vector;
 }
 
+/*
+** Vector growth policy: when an append or insert outgrows the buffer, the
+** new capacity is the larger of what is needed and size * Num / Den.
+** Doubling (the default, as libstdc++) keeps pushes cheapest; 3/2 leaves
+** less slack and lets the allocator reuse freed blocks for later growth.
+*/
+template <unsigned Num, unsigned Den>
+struct ft::geometric_growth
+{
+	static std::size_t next(std::size_t size, std::size_t needed)
+	{
+		std::size_t grown = size / Den * Num + size % Den * Num / Den;
+		return grown > needed ? grown : needed;
+	}
+};
+
+// shared by every vector_base of T and A, so a small_vector's iterators are a vector's
 template <class T, class A>
-class ft::vector
+struct ft::vector_iterators
 {
-public:
-	typedef typename A::value_type value_type;
-	typedef typename A::reference reference;
-	typedef typename A::const_reference const_reference;
-	typedef typename A::difference_type difference_type;
 	typedef typename A::size_type size_type;
 
 	class const_iterator
@@ -90,6 +115,26 @@ public:
 		pointer operator->() const { return cit::_ptr; }
 		reference operator[](size_type n) const { return *(cit::_ptr + n); }
 	};
+};
+
+/*
+** What ft::vector and ft::small_vector have in common: element access
+** and every operation that adds or removes elements, growing by Growth
+** and moving elements through ft::uninitialized. Buffer is the container
+** itself and owns the memory; it may hide the defaults at the bottom
+** (vector maps large buffers, small_vector keeps an inline one).
+*/
+template <class T, class A, class Growth, class Buffer>
+class ft::vector_base : public ft::vector_iterators<T, A>
+{
+public:
+	typedef typename A::value_type value_type;
+	typedef typename A::reference reference;
+	typedef typename A::const_reference const_reference;
+	typedef typename A::difference_type difference_type;
+	typedef typename A::size_type size_type;
+	typedef typename vector_iterators<T, A>::const_iterator const_iterator;
+	typedef typename vector_iterators<T, A>::iterator iterator;
 
 	iterator begin() { return iterator(_values); }
 	const_iterator begin() const { return const_iterator(_values); }
@@ -104,45 +149,16 @@ public:
 	reverse_iterator rend()	{ return reverse_iterator(begin());	}
 	const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
 
-	vector() : _capacity(0),
-			   _size(0),
-			   _values(NULL) {}
-	explicit vector(size_type count) : _capacity(count),
-									   _size(count),
-									   _values(_alloc.allocate(count)) {}
-	vector(const vector &other) : _capacity(0),
-								  _size(0),
-								  _values(NULL) { *this = other; }
-	template <class InputIt>
-	vector(InputIt first, InputIt last,
-		   const A &alloc = std::allocator<T>()) : _alloc(alloc),
-												   _capacity(0),
-												   _size(0),
-												   _values(NULL) { assign(first, last); }
-	~vector()
-	{
-		for (size_type i = 0; i < _size; i++)
-			_alloc.destroy(_values + i);
-		if (_values)
-			_alloc.deallocate(_values, _capacity);
-	}
-	vector &operator=(const vector &other)
-	{
-		if (this == &other)
-			return *this;
-		clear();
-		reserve(other._size);
-		_size = other._size;
-		for (size_type i = 0; i < _size; i++)
-			_values[i] = other._values[i];
-		return *this;
-	}
 	A get_allocator() const { return _alloc; }
 	T *data() { return _values;	}
 	T const *data() const { return _values; }
 	size_type size() const { return _size; }
 	size_type capacity() const { return _capacity; }
+#if __cplusplus >= 201103L
+	size_type max_size() const { return std::allocator_traits<A>::max_size(_alloc); }
+#else
 	size_type max_size() const { return _alloc.max_size(); }
+#endif
 	T &front() { return _values[0]; }
 	T const &front() const { return _values[0]; }
 	T &back() { return _values[_size - 1]; }
@@ -172,45 +188,72 @@ public:
 	{
 		if (new_cap <= _capacity)
 			return;
-		new_cap = std::max(new_cap, _size * 2);
-		T *_new_values = _alloc.allocate(new_cap);
-		for (size_type i = 0; i < _size; i++)
-			_new_values[i] = _values[i];
-		if (_values)
-			_alloc.deallocate(_values, _capacity);
-		_values = _new_values;
-		_capacity = new_cap;
+		reallocate(new_cap);
 	}
 	void clear()
 	{
-		for (size_type i = 0; i < _size; i++)
-			_alloc.destroy(_values + i);
+		ops::destroy(_alloc, _values, _values + _size);
 		_size = 0;
+		if (Buffer::mapped(_capacity))
+			Buffer::discard_pages(_values, _capacity * sizeof(T));
 	}
+#if __cplusplus >= 201103L
+	void push_back(const T &value) { emplace_back(value); }
+	void push_back(T &&value) { emplace_back(std::move(value)); }
+	template <class... Args>
+	reference emplace_back(Args &&...args)
+	{
+		if (_size == _capacity)
+			append_realloc(std::forward<Args>(args)...);
+		else
+			ops::construct(_alloc, _values + _size, std::forward<Args>(args)...);
+		return _values[_size++];
+	}
+	template <class... Args>
+	iterator emplace(const_iterator position, Args &&...args)
+	{
+		size_type idx = position - const_iterator(_values);
+		if (idx == _size)
+		{
+			emplace_back(std::forward<Args>(args)...);
+			return iterator(_values + idx);
+		}
+		T v(std::forward<Args>(args)...);
+		open_gap(idx, 1);
+		try { ops::construct(_alloc, _values + idx, std::move(v)); }
+		catch (...) { close_gap(idx, 1); throw; }
+		_size++;
+		return iterator(_values + idx);
+	}
+#else
 	void push_back(const T &value)
 	{
 		if (_size == _capacity)
-			reserve(_size ? _size * 2 : 1);
-		_values[_size++] = value;
+			append_realloc(value);
+		else
+			ops::construct(_alloc, _values + _size, value);
+		_size++;
 	}
-	void pop_back() { _size--; }
+#endif
+	void pop_back() { ops::destroy_at(_alloc, _values + --_size); }
 	void resize(size_type count, T value = T())
 	{
-		reserve(count);
-		while (_size < count)
-			_values[_size++] = value;
+		if (count < _size)
+		{
+			ops::destroy(_alloc, _values + count, _values + _size);
+			_size = count;
+			return;
+		}
+		if (count > _capacity)
+			reallocate(Growth::next(_size, count));
+		ops::construct_fill(_alloc, _values + _size, count - _size, value);
 		_size = count;
 	}
-	void swap(vector &other)
-	{
-		std::swap(_values, other._values);
-		std::swap(_size, other._size);
-		std::swap(_capacity, other._capacity);
-	}
 	void assign(size_type count, const T &value)
 	{
+		T v(value);
 		clear();
-		resize(count, value);
+		resize(count, v);
 	}
 	template <class InputIt>
 	void assign(InputIt first,
@@ -219,30 +262,32 @@ public:
 		clear();
 		size_type t = std::distance(first, last);
 		reserve(t);
+		ops::construct_range(_alloc, _values, first, t);
 		_size = t;
-		int i = 0;
-		while (first != last)
-			_values[i++] = *first++;
 	}
+#if __cplusplus >= 201103L
+	iterator insert(iterator position, const T &val) { return emplace(position, val); }
+	iterator insert(iterator position, T &&val) { return emplace(position, std::move(val)); }
+#else
 	iterator insert(iterator position, const T &val)
 	{
 		size_type idx = std::distance(begin(), position);
-		reserve(_size + 1);
-		for (size_type i = _size; i > idx; i--)
-			_values[i] = _values[i - 1];
+		T v(val);
+		open_gap(idx, 1);
+		try { ops::construct_fill(_alloc, _values + idx, 1, v); }
+		catch (...) { close_gap(idx, 1); throw; }
 		_size++;
-		_values[idx] = val;
 		return iterator(_values + idx);
 	}
+#endif
 	void insert(iterator position, size_type n, const T &val)
 	{
 		size_type idx = std::distance(begin(), position);
-		reserve(_size + n);
-		for (size_type i = _size; i > idx; i--)
-			_values[i - 1 + n] = _values[i - 1];
+		T v(val);
+		open_gap(idx, n);
+		try { ops::construct_fill(_alloc, _values + idx, n, v); }
+		catch (...) { close_gap(idx, n); throw; }
 		_size += n;
-		for (size_type i = 0; i < n; i++)
-			_values[idx + i] = val;
 	}
 	template <class InputIt>
 	void insert(iterator position, InputIt first,
@@ -250,40 +295,345 @@ public:
 	{
 		size_type idx = std::distance(begin(), position);
 		size_type n = std::distance(first, last);
-		reserve(_size + n);
-		for (size_type i = _size; i > idx; i--)
-			_values[i - 1 + n] = _values[i - 1];
+		open_gap(idx, n);
+		try { ops::construct_range(_alloc, _values + idx, first, n); }
+		catch (...) { close_gap(idx, n); throw; }
 		_size += n;
-		for (size_type i = 0; i < n; i++)
-			_values[idx + i] = *first++;
 	}
 	iterator erase(iterator pos)
 	{
-		size_type idx = pos - begin();
-		for (size_type i = idx; i < _size - 1; i++)
-			_values[i] = _values[i + 1];
-		_size--;
-		return iterator(_values + idx);
+		return erase(pos, pos + 1);
 	}
 	iterator erase(iterator first, iterator last)
 	{
 		size_type idx = first - begin();
 		size_type n = last - first;
-		for (size_type i = idx; i < _size - n; i++)
-			_values[i] = _values[i + n];
+		ops::shift_down(_alloc, _values + idx, _values + idx + n, _size - idx - n);
 		_size -= n;
 		return iterator(_values + idx);
 	}
 
-private:
+protected:
+	vector_base(const A &alloc) : _alloc(alloc),
+								  _capacity(0),
+								  _size(0),
+								  _values(NULL) {}
+	~vector_base() {}
+	void assign_copy(const vector_base &other)
+	{
+		if (this == &other)
+			return;
+		if (other._size > _capacity)
+		{
+			clear();
+			reserve(other._size);
+			ops::construct_copy(_alloc, _values, other._values, other._size);
+		}
+		else if (other._size > _size)
+		{
+			ops::copy_assign(_values, other._values, _size);
+			ops::construct_copy(_alloc, _values + _size, other._values + _size, other._size - _size);
+		}
+		else
+		{
+			ops::copy_assign(_values, other._values, other._size);
+			ops::destroy(_alloc, _values + other._size, _values + _size);
+		}
+		_size = other._size;
+	}
+	/*
+	** Buffer's constructors fill it through these: no destructor runs for
+	** an object whose constructor threw, so a throw frees what was built.
+	*/
+	void init_fill(size_type count, const T &value)
+	{
+		try { resize(count, value); }
+		catch (...) { release(); throw; }
+	}
+	void init_copy(const vector_base &other)
+	{
+		try { assign_copy(other); }
+		catch (...) { release(); throw; }
+	}
+	template <class InputIt>
+	void init_range(InputIt first, InputIt last)
+	{
+		try { assign(first, last); }
+		catch (...) { release(); throw; }
+	}
+	void release()
+	{
+		clear();
+		self().deallocate(_values, _capacity);
+		_values = NULL;
+		_capacity = 0;
+	}
+
 	A _alloc;
 	size_type _capacity;
 	size_type _size;
 	T *_values;
+
+	// element transfer (raw bytes for trivially copyable T)
+	typedef uninitialized<T, A> ops;
+	typedef typename ops::trivial trivial;
+
+#if __cplusplus >= 201103L
+	// the new element is built before the old ones move: args may alias them
+	template <class... Args>
+	void append_realloc(Args &&...args)
+	{
+		size_type new_cap = Growth::next(_size, _size + 1);
+		if (Buffer::mapped(new_cap))
+		{
+			T v(std::forward<Args>(args)...);
+			reallocate(new_cap);
+			ops::construct(_alloc, _values + _size, v);
+			return;
+		}
+		T *_new_values = self().allocate(new_cap);
+		try { ops::construct(_alloc, _new_values + _size, std::forward<Args>(args)...); }
+		catch (...) { self().deallocate(_new_values, new_cap); throw; }
+		try { ops::relocate(_alloc, _new_values, _values, _size); }
+		catch (...)
+		{
+			ops::destroy_at(_alloc, _new_values + _size);
+			self().deallocate(_new_values, new_cap);
+			throw;
+		}
+		self().deallocate(_values, _capacity);
+		_values = _new_values;
+		_capacity = new_cap;
+	}
+#else
+	// the new element is built before the old ones move: value may alias them
+	void append_realloc(const T &value)
+	{
+		size_type new_cap = Growth::next(_size, _size + 1);
+		if (Buffer::mapped(new_cap))
+		{
+			T v(value);
+			reallocate(new_cap);
+			ops::construct(_alloc, _values + _size, v);
+			return;
+		}
+		T *_new_values = self().allocate(new_cap);
+		try { ops::construct(_alloc, _new_values + _size, value); }
+		catch (...) { self().deallocate(_new_values, new_cap); throw; }
+		try { ops::relocate(_alloc, _new_values, _values, _size); }
+		catch (...)
+		{
+			ops::destroy_at(_alloc, _new_values + _size);
+			self().deallocate(_new_values, new_cap);
+			throw;
+		}
+		self().deallocate(_values, _capacity);
+		_values = _new_values;
+		_capacity = new_cap;
+	}
+#endif
+
+	// leaves [idx, idx + n) as raw memory, growing the buffer if needed
+	void open_gap(size_type idx, size_type n)
+	{
+		if (_size + n <= _capacity)
+		{
+			ops::relocate(_alloc, _values + idx + n, _values + idx, _size - idx);
+			return;
+		}
+		size_type new_cap = Growth::next(_size, _size + n);
+		if (Buffer::mapped(new_cap))
+		{
+			reallocate(new_cap);
+			ops::relocate(_alloc, _values + idx + n, _values + idx, _size - idx);
+			return;
+		}
+		T *_new_values = self().allocate(new_cap);
+		try { ops::relocate_around(_alloc, _new_values, _values, _size, idx, n); }
+		catch (...) { self().deallocate(_new_values, new_cap); throw; }
+		self().deallocate(_values, _capacity);
+		_values = _new_values;
+		_capacity = new_cap;
+	}
+	// should that throw, the elements after the gap are dropped rather than left behind it
+	void close_gap(size_type idx, size_type n)
+	{
+		try { ops::relocate(_alloc, _values + idx, _values + idx + n, _size - idx); }
+		catch (...)
+		{
+			ops::destroy(_alloc, _values + idx + n, _values + _size + n);
+			_size = idx;
+			throw;
+		}
+	}
+
+	// moves the live elements into room for new_cap, remapping when both sides are mapped
+	void reallocate(size_type new_cap)
+	{
+		if (Buffer::mapped(_capacity) && Buffer::mapped(new_cap))
+			_values = static_cast<T *>(Buffer::remap_pages(_values, _capacity * sizeof(T), new_cap * sizeof(T)));
+		else
+		{
+			T *_new_values = self().allocate(new_cap);
+			try { ops::relocate(_alloc, _new_values, _values, _size); }
+			catch (...) { self().deallocate(_new_values, new_cap); throw; }
+			self().deallocate(_values, _capacity);
+			_values = _new_values;
+		}
+		_capacity = new_cap;
+	}
+
+	// the buffer, unless Buffer has its own
+	T *allocate(size_type n) { return _alloc.allocate(n); }
+	void deallocate(T *p, size_type n)
+	{
+		if (p)
+			_alloc.deallocate(p, n);
+	}
+	static bool mapped(size_type) { return false; }
+	static void *remap_pages(void *, size_type, size_type) { throw std::bad_alloc(); }
+	static void discard_pages(void *, size_type) {}
+
+private:
+	Buffer &self() { return static_cast<Buffer &>(*this); }
+};
+
+template <class T, class A, class Growth>
+class ft::vector : public ft::vector_base<T, A, Growth, ft::vector<T, A, Growth> >
+{
+	typedef vector_base<T, A, Growth, vector> base;
+	friend class vector_base<T, A, Growth, vector>;
+
+public:
+	typedef typename base::size_type size_type;
+
+	vector() : base(A()) {}
+	explicit vector(const A &alloc) : base(alloc) {}
+	explicit vector(size_type count, const T &value = T(),
+					const A &alloc = A()) : base(alloc) { this->init_fill(count, value); }
+	vector(const vector &other) : base(allocator_copy<A>::select(other._alloc)) { this->init_copy(other); }
+#if __cplusplus >= 201103L
+	vector(vector &&other) noexcept : base(other._alloc)
+	{
+		_capacity = other._capacity;
+		_size = other._size;
+		_values = other._values;
+		other._capacity = 0;
+		other._size = 0;
+		other._values = NULL;
+	}
+#endif
+	template <class InputIt>
+	vector(InputIt first, InputIt last,
+		   const A &alloc = A()) : base(alloc) { this->init_range(first, last); }
+	~vector()
+	{
+		ops::destroy(_alloc, _values, _values + _size);
+		deallocate(_values, _capacity);
+	}
+	vector &operator=(const vector &other)
+	{
+		this->assign_copy(other);
+		return *this;
+	}
+#if __cplusplus >= 201103L
+	vector &operator=(vector &&other) noexcept
+	{
+		if (this != &other)
+		{
+			vector t(std::move(other));
+			swap(t);
+		}
+		return *this;
+	}
+#endif
+	void shrink_to_fit()
+	{
+		if (_capacity == _size)
+			return;
+		if (_size)
+		{
+			this->reallocate(_size);
+			return;
+		}
+		deallocate(_values, _capacity);
+		_values = NULL;
+		_capacity = 0;
+	}
+	void swap(vector &other)
+	{
+		std::swap(_values, other._values);
+		std::swap(_size, other._size);
+		std::swap(_capacity, other._capacity);
+		std::swap(_alloc, other._alloc);
+	}
+
+private:
+	using base::_alloc;
+	using base::_capacity;
+	using base::_size;
+	using base::_values;
+	typedef typename base::ops ops;
+	typedef typename ops::trivial trivial;
+
+	/*
+	** Large buffers. Trivially copyable elements under std::allocator get
+	** their own mapping once the buffer reaches LARGE_BUFFER bytes. Growing
+	** a mapped buffer goes through mremap, which moves page tables rather
+	** than copying data, so there is no second copy alive at peak; clear()
+	** hands the pages back with madvise. Whether a buffer is mapped follows
+	** from its capacity alone.
+	*/
+	enum { LARGE_BUFFER = 1 << 21 };
+#ifdef __linux__
+	typedef integral_constant<bool, trivial::value && is_same<A, std::allocator<T> >::value> mappable;
+#else
+	typedef false_type mappable;
+#endif
+	static bool mapped(size_type cap) { return mappable::value && cap * sizeof(T) >= LARGE_BUFFER; }
+	T *allocate(size_type n)
+	{
+		if (mapped(n))
+			return static_cast<T *>(map_pages(n * sizeof(T)));
+		return _alloc.allocate(n);
+	}
+	void deallocate(T *p, size_type n)
+	{
+		if (!p)
+			return;
+		if (mapped(n))
+			unmap_pages(p, n * sizeof(T));
+		else
+			_alloc.deallocate(p, n);
+	}
+#ifdef __linux__
+	static void *map_pages(size_type bytes)
+	{
+		void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p == MAP_FAILED)
+			throw std::bad_alloc();
+		return p;
+	}
+	static void *remap_pages(void *p, size_type old_bytes, size_type new_bytes)
+	{
+		p = mremap(p, old_bytes, new_bytes, MREMAP_MAYMOVE);
+		if (p == MAP_FAILED)
+			throw std::bad_alloc();
+		return p;
+	}
+	static void unmap_pages(void *p, size_type bytes) { munmap(p, bytes); }
+	static void discard_pages(void *p, size_type bytes) { madvise(p, bytes, MADV_DONTNEED); }
+#else
+	// never called: mappable is false_type
+	static void *map_pages(size_type) { throw std::bad_alloc(); }
+	static void *remap_pages(void *, size_type, size_type) { throw std::bad_alloc(); }
+	static void unmap_pages(void *, size_type) {}
+	static void discard_pages(void *, size_type) {}
+#endif
 };
 
-template <typename T, typename A>
-bool operator==(const ft::vector<T, A> &lhs, const ft::vector<T, A> &rhs)
+template <typename T, typename A, typename G, typename B>
+bool operator==(const ft::vector_base<T, A, G, B> &lhs, const ft::vector_base<T, A, G, B> &rhs)
 {
 	unsigned sz = lhs.size();
 	if (sz != rhs.size())
@@ -294,12 +644,12 @@ bool operator==(const ft::vector<T, A> &lhs, const ft::vector<T, A> &rhs)
 	return i == sz;
 }
 
-template <typename T, typename A>
-bool operator!=(const ft::vector<T, A> &lhs,
-				const ft::vector<T, A> &rhs) {	return !(lhs == rhs); }
+template <typename T, typename A, typename G, typename B>
+bool operator!=(const ft::vector_base<T, A, G, B> &lhs,
+				const ft::vector_base<T, A, G, B> &rhs) {	return !(lhs == rhs); }
 
-template <typename T, typename A>
-bool operator<(const ft::vector<T, A> &lhs, const ft::vector<T, A> &rhs)
+template <typename T, typename A, typename G, typename B>
+bool operator<(const ft::vector_base<T, A, G, B> &lhs, const ft::vector_base<T, A, G, B> &rhs)
 {
 	unsigned i = 0, lsz = lhs.size(), rsz = rhs.size();
 	while (i < lsz && i < rsz && lhs[i] == rhs[i])
@@ -307,18 +657,18 @@ bool operator<(const ft::vector<T, A> &lhs, const ft::vector<T, A> &rhs)
 	return (i == lsz && i < rsz) || (i < lsz && i < rsz && lhs[i] < rhs[i]);
 }
 
-template <typename T, typename A>
-bool operator>=(const ft::vector<T, A> &lhs,
-				const ft::vector<T, A> &rhs) { return !(lhs < rhs); }
+template <typename T, typename A, typename G, typename B>
+bool operator>=(const ft::vector_base<T, A, G, B> &lhs,
+				const ft::vector_base<T, A, G, B> &rhs) { return !(lhs < rhs); }
 
-template <typename T, typename A>
-bool operator>(const ft::vector<T, A> &lhs,
-			   const ft::vector<T, A> &rhs) { return (rhs < lhs); }
+template <typename T, typename A, typename G, typename B>
+bool operator>(const ft::vector_base<T, A, G, B> &lhs,
+			   const ft::vector_base<T, A, G, B> &rhs) { return (rhs < lhs); }
 
-template <typename T, typename A>
-bool operator<=(const ft::vector<T, A> &lhs,
-				const ft::vector<T, A> &rhs) { return !(rhs < lhs); }
+template <typename T, typename A, typename G, typename B>
+bool operator<=(const ft::vector_base<T, A, G, B> &lhs,
+				const ft::vector_base<T, A, G, B> &rhs) { return !(rhs < lhs); }
 
-template <typename T, typename A>
-void swap(ft::vector<T, A> &lhs,
-		  ft::vector<T, A> &rhs) { lhs.swap(rhs); }
+template <typename T, typename A, typename G>
+void swap(ft::vector<T, A, G> &lhs,
+		  ft::vector<T, A, G> &rhs) { lhs.swap(rhs); }